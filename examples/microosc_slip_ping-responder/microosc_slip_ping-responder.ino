@@ -0,0 +1,58 @@
+/*
+  MicroOsc SLIP ping responder.
+  By Thomas O Fredericks.
+  2026-10-19
+
+  WHAT IS DOES
+  ======================
+  Answers every /microosc/ping message with a /microosc/pong message that contains the same arguments.
+  Used with the latency harness in extras/nodeJs/latency to measure the round-trip latency and jitter of MicroOsc.
+  The same replyToPing() call works with MicroOscUdp.
+
+  HARDWARE REQUIREMENTS
+  ==================
+  - Any "regular" Arduino.
+
+  REQUIRED LIBRARIES
+  ==================
+  - MicroOsc.
+
+  REQUIRED CONFIGURATION
+  ======================
+  - Set the baud of the latency harness to 115200.
+
+*/
+
+#include <MicroOscSlip.h>
+
+// THE NUMBER 256 BETWEEN THE < > SYMBOLS  BELOW IS THE MAXIMUM NUMBER OF BYTES RESERVED FOR INCOMMING MESSAGES.
+// IT LIMITS THE PAYLOAD SIZE THAT CAN BE TESTED.
+MicroOscSlip<256> myMicroOsc(&Serial);  // CREATE AN INSTANCE OF MicroOsc FOR SLIP MESSAGES
+
+/********
+  SETUP
+*********/
+void setup() {
+
+  Serial.begin(115200);
+}
+
+/****************
+  myOnOscMessageReceived is triggered when a message is received
+*****************/
+void myOnOscMessageReceived(MicroOscMessage& oscMessage) {
+
+  // ANSWER /microosc/ping WITH /microosc/pong
+  if (myMicroOsc.replyToPing(oscMessage)) return;
+
+  // HANDLE OTHER MESSAGES HERE
+}
+
+/*******
+  LOOP
+********/
+void loop() {
+
+  // TRIGGER myOnOscMessageReceived() IF AN OSC MESSAGE IS RECEIVED :
+  myMicroOsc.onOscMessageReceived(myOnOscMessageReceived);
+}
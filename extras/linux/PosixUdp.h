@@ -0,0 +1,127 @@
+/* PosixUdp
+ * Arduino UDP API over a BSD socket, to use MicroOscUdp on a Linux host.
+ */
+
+#ifndef _MICRO_OSC_POSIX_UDP_
+#define _MICRO_OSC_POSIX_UDP_
+
+#include <Udp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class PosixUdp : public UDP
+{
+  int fd_ = -1;
+  struct sockaddr_in destination_;
+  uint8_t tx_[65507];
+  size_t tx_length_ = 0;
+  uint8_t rx_[65507];
+  size_t rx_length_ = 0;
+  size_t rx_position_ = 0;
+
+public:
+  ~PosixUdp()
+  {
+    stop();
+  }
+
+  /**
+   * Listens on port, without blocking. Returns 1 on success.
+   */
+  int begin(uint16_t port)
+  {
+    fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd_ < 0)
+      return 0;
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(port);
+    if (bind(fd_, (struct sockaddr *)&local, sizeof(local)) != 0)
+    {
+      stop();
+      return 0;
+    }
+    fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK);
+    return 1;
+  }
+
+  void stop()
+  {
+    if (fd_ >= 0)
+      close(fd_);
+    fd_ = -1;
+  }
+
+  int getFileDescriptor()
+  {
+    return fd_;
+  }
+
+  int beginPacket(IPAddress ip, uint16_t port) override
+  {
+    memset(&destination_, 0, sizeof(destination_));
+    destination_.sin_family = AF_INET;
+    destination_.sin_addr.s_addr = htonl(((uint32_t)ip[0] << 24) | ((uint32_t)ip[1] << 16) | ((uint32_t)ip[2] << 8) | ip[3]);
+    destination_.sin_port = htons(port);
+    tx_length_ = 0;
+    return 1;
+  }
+
+  int endPacket() override
+  {
+    return sendto(fd_, tx_, tx_length_, 0, (struct sockaddr *)&destination_, sizeof(destination_)) == (ssize_t)tx_length_;
+  }
+
+  size_t write(uint8_t b) override
+  {
+    return write(&b, 1);
+  }
+
+  size_t write(const uint8_t *buffer, size_t size) override
+  {
+    if (size > sizeof(tx_) - tx_length_)
+      size = sizeof(tx_) - tx_length_;
+    memcpy(tx_ + tx_length_, buffer, size);
+    tx_length_ += size;
+    return size;
+  }
+
+  int parsePacket() override
+  {
+    ssize_t n = recv(fd_, rx_, sizeof(rx_), 0);
+    rx_length_ = (n > 0) ? n : 0;
+    rx_position_ = 0;
+    return rx_length_;
+  }
+
+  int available() override
+  {
+    return rx_length_ - rx_position_;
+  }
+
+  int read() override
+  {
+    return (rx_position_ < rx_length_) ? rx_[rx_position_++] : -1;
+  }
+
+  int read(unsigned char *buffer, size_t length) override
+  {
+    size_t n = rx_length_ - rx_position_;
+    if (n > length)
+      n = length;
+    memcpy(buffer, rx_ + rx_position_, n);
+    rx_position_ += n;
+    return n;
+  }
+
+  int peek() override
+  {
+    return (rx_position_ < rx_length_) ? rx_[rx_position_] : -1;
+  }
+};
+
+#endif // _MICRO_OSC_POSIX_UDP_
@@ -0,0 +1,29 @@
+/* Minimal Arduino API to build MicroOsc on a Linux host.
+ * Only what MicroOsc and the programs of extras/linux use.
+ */
+
+#ifndef _MICRO_OSC_HOST_ARDUINO_
+#define _MICRO_OSC_HOST_ARDUINO_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Print.h"
+#include "Stream.h"
+
+static inline unsigned long micros()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long)((uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+}
+
+static inline unsigned long millis()
+{
+  return micros() / 1000;
+}
+
+#endif // _MICRO_OSC_HOST_ARDUINO_
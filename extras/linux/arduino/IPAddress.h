@@ -0,0 +1,42 @@
+#ifndef _MICRO_OSC_HOST_IP_ADDRESS_
+#define _MICRO_OSC_HOST_IP_ADDRESS_
+
+#include <stdint.h>
+#include <string.h>
+#include <netinet/in.h>
+
+class IPAddress
+{
+  uint8_t bytes_[4];
+
+public:
+  IPAddress()
+  {
+    memset(bytes_, 0, 4);
+  }
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+  {
+    bytes_[0] = a;
+    bytes_[1] = b;
+    bytes_[2] = c;
+    bytes_[3] = d;
+  }
+  uint8_t operator[](int index) const
+  {
+    return bytes_[index];
+  }
+  bool operator==(const IPAddress &other) const
+  {
+    return memcmp(bytes_, other.bytes_, 4) == 0;
+  }
+  bool operator!=(const IPAddress &other) const
+  {
+    return !(*this == other);
+  }
+};
+
+// like the Arduino cores, INADDR_NONE is the IPAddress 0.0.0.0 and not the one of <netinet/in.h>
+#undef INADDR_NONE
+#define INADDR_NONE IPAddress(0, 0, 0, 0)
+
+#endif // _MICRO_OSC_HOST_IP_ADDRESS_
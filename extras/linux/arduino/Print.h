@@ -0,0 +1,35 @@
+#ifndef _MICRO_OSC_HOST_PRINT_
+#define _MICRO_OSC_HOST_PRINT_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size)
+  {
+    size_t n = 0;
+    while (size--)
+      n += write(*buffer++);
+    return n;
+  }
+  size_t write(const char *str)
+  {
+    return write((const uint8_t *)str, strlen(str));
+  }
+  size_t print(const char *str)
+  {
+    return write(str);
+  }
+  virtual int availableForWrite()
+  {
+    return 0;
+  }
+  virtual void flush() {}
+};
+
+#endif // _MICRO_OSC_HOST_PRINT_
@@ -0,0 +1,31 @@
+#ifndef _MICRO_OSC_HOST_STREAM_
+#define _MICRO_OSC_HOST_STREAM_
+
+#include "Print.h"
+
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  size_t readBytes(uint8_t *buffer, size_t length)
+  {
+    size_t count = 0;
+    while (count < length)
+    {
+      int c = read();
+      if (c < 0)
+        break;
+      buffer[count++] = (uint8_t)c;
+    }
+    return count;
+  }
+  size_t readBytes(char *buffer, size_t length)
+  {
+    return readBytes((uint8_t *)buffer, length);
+  }
+};
+
+#endif // _MICRO_OSC_HOST_STREAM_
@@ -0,0 +1,17 @@
+#ifndef _MICRO_OSC_HOST_UDP_
+#define _MICRO_OSC_HOST_UDP_
+
+#include "Stream.h"
+#include "IPAddress.h"
+
+class UDP : public Stream
+{
+public:
+  virtual int beginPacket(IPAddress ip, uint16_t port) = 0;
+  virtual int endPacket() = 0;
+  virtual int parsePacket() = 0;
+  virtual int read(unsigned char *buffer, size_t length) = 0;
+  using Stream::read;
+};
+
+#endif // _MICRO_OSC_HOST_UDP_
@@ -0,0 +1,184 @@
+/*
+  MicroOsc shared memory vs loopback UDP benchmark.
+
+  WHAT IS DOES
+  ======================
+  Forks an echo process and measures the round trip of count /bench/ping messages
+  (an int and a blob of payload bytes) with MicroOscShm and with MicroOscUdp over 127.0.0.1.
+  Every message waits for its echo before the next one is sent.
+
+  BUILD AND RUN
+  ======================
+  See extras/linux/README.md.
+*/
+
+#include <MicroOscShm.h>
+#include <MicroOscUdp.h>
+#include <PosixUdp.h>
+
+#include <algorithm>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <vector>
+
+#define BENCH_SHM_NAME "/microosc-benchmark"
+#define BENCH_UDP_PORT_A 9123
+#define BENCH_UDP_PORT_B 9124
+
+static bool echoStopped;
+static int32_t pongSequence;
+
+static uint64_t nowNanos()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+// ECHO PROCESS: sends every ping back unchanged
+static void echo(MicroOsc &source, MicroOscMessage &msg)
+{
+  if (msg.checkOscAddress("/bench/stop"))
+    echoStopped = true;
+  else
+    source.forwardMessage(msg);
+}
+
+static void pong(MicroOscMessage &msg)
+{
+  if (msg.checkOscAddress("/bench/ping"))
+    pongSequence = msg.nextAsInt();
+}
+
+static bool waitReadable(int fd, int timeoutMillis)
+{
+  struct pollfd p = {fd, POLLIN, 0};
+  return poll(&p, 1, timeoutMillis) > 0;
+}
+
+static void report(const char *name, std::vector<uint64_t> &samples, uint64_t total)
+{
+  std::sort(samples.begin(), samples.end());
+  size_t n = samples.size();
+  printf("%-12s round trip p50 %6.2f us, p99 %6.2f us, max %8.2f us, %9.0f messages/s\n", name,
+         samples[n / 2] / 1000.0, samples[n * 99 / 100] / 1000.0, samples[n - 1] / 1000.0,
+         2.0 * n * 1e9 / total);
+}
+
+/*******
+  SHM
+********/
+static void benchShm(int count, const uint8_t *payload, int payloadLength)
+{
+  MicroOscShm<> osc;
+  if (!osc.create(BENCH_SHM_NAME, 2048, 64))
+  {
+    printf("Can not create " BENCH_SHM_NAME "\n");
+    return;
+  }
+
+  pid_t child = fork();
+  if (child == 0)
+  {
+    MicroOscShm<> peer;
+    peer.open(BENCH_SHM_NAME);
+    while (!echoStopped)
+    {
+      peer.wait(100000);
+      peer.onOscMessageReceived(echo);
+    }
+    _exit(0);
+  }
+
+  std::vector<uint64_t> samples;
+  samples.reserve(count);
+  uint64_t start = nowNanos();
+  for (int32_t i = 0; i < count; i++)
+  {
+    uint64_t sent = nowNanos();
+    osc.sendMessage("/bench/ping", "ib", i, payload, payloadLength);
+    while (pongSequence != i)
+    {
+      osc.wait(1000000);
+      osc.onOscMessageReceived(pong);
+    }
+    samples.push_back(nowNanos() - sent);
+  }
+  uint64_t total = nowNanos() - start;
+
+  osc.sendMessage("/bench/stop", "");
+  waitpid(child, NULL, 0);
+  MicroOscShmChannel::unlink(BENCH_SHM_NAME);
+  report("shm", samples, total);
+}
+
+/*******
+  UDP
+********/
+static void benchUdp(int count, const uint8_t *payload, int payloadLength)
+{
+  pid_t child = fork();
+  if (child == 0)
+  {
+    PosixUdp udp;
+    udp.begin(BENCH_UDP_PORT_B);
+    MicroOscUdp<2048> peer(&udp, IPAddress(127, 0, 0, 1), BENCH_UDP_PORT_A);
+    while (!echoStopped)
+    {
+      if (waitReadable(udp.getFileDescriptor(), 100))
+        peer.onOscMessageReceived(echo);
+    }
+    _exit(0);
+  }
+
+  PosixUdp udp;
+  udp.begin(BENCH_UDP_PORT_A);
+  MicroOscUdp<2048> osc(&udp, IPAddress(127, 0, 0, 1), BENCH_UDP_PORT_B);
+  usleep(100000); // let the echo process bind its port
+
+  std::vector<uint64_t> samples;
+  samples.reserve(count);
+  pongSequence = -1;
+  uint64_t start = nowNanos();
+  for (int32_t i = 0; i < count; i++)
+  {
+    uint64_t sent = nowNanos();
+    osc.sendMessage("/bench/ping", "ib", i, payload, payloadLength);
+    while (pongSequence != i)
+    {
+      if (!waitReadable(udp.getFileDescriptor(), 1000))
+      {
+        printf("udp: ping %d lost\n", (int)i);
+        kill(child, SIGTERM);
+        return;
+      }
+      osc.onOscMessageReceived(pong);
+    }
+    samples.push_back(nowNanos() - sent);
+  }
+  uint64_t total = nowNanos() - start;
+
+  osc.sendMessage("/bench/stop", "");
+  waitpid(child, NULL, 0);
+  report("udp loopback", samples, total);
+}
+
+int main(int argc, char **argv)
+{
+  int count = (argc > 1) ? atoi(argv[1]) : 100000;
+  int payloadLength = (argc > 2) ? atoi(argv[2]) : 32;
+  if (count <= 0 || payloadLength < 0 || payloadLength > 1024)
+  {
+    printf("usage: shm_benchmark [count] [payload (0 to 1024 bytes)]\n");
+    return 2;
+  }
+  std::vector<uint8_t> payload(payloadLength + 1, 0x55);
+
+  printf("%d round trips, %d bytes of payload\n", count, payloadLength);
+  pongSequence = -1;
+  benchShm(count, payload.data(), payloadLength);
+  benchUdp(count, payload.data(), payloadLength);
+  return 0;
+}
@@ -0,0 +1,232 @@
+/*******************
+ * CONFIGURATION   *
+ *******************/
+// Every option can be overridden on the command line, for example:
+//   node index.js --transport udp --host 127.0.0.1 --port 8888 --rate 500 --payload 64
+//   node index.js --transport serial --serialPath /dev/pts/3 --maxP99 2000
+//   node index.js --responder true --transport udp --localPort 8888
+let config = {
+    transport: "udp",          // "udp" or "serial" (SLIP)
+    host: "127.0.0.1",         // UDP destination (the responder)
+    port: 8888,                // UDP destination port
+    localPort: 7777,           // UDP listening port
+    serialPath: "/dev/ttyUSB0",// serial device or pty (see README.md)
+    serialBaud: 115200,
+    rate: 100,                 // pings per second
+    count: 1000,               // number of measured pings
+    warmup: 20,                // pings sent before measuring
+    payload: 0,                // blob payload size in bytes
+    timeout: 1000,             // ms before a ping is counted as lost
+    maxP99: 0,                 // if > 0, exit with an error when p99 (us) is higher
+    responder: false           // answer pings instead of sending them
+};
+
+/*********************
+ * CODE FROM HERE ON *
+ *********************/
+let osc = require("osc");
+
+for (let i = 2; i + 1 < process.argv.length; i += 2) {
+    let key = process.argv[i].replace(/^--/, "");
+    if (!(key in config)) {
+        console.log("Unknown option --" + key);
+        process.exit(2);
+    }
+    let value = process.argv[i + 1];
+    config[key] = (typeof config[key] === "number") ? Number(value)
+        : (typeof config[key] === "boolean") ? (value === "true")
+        : value;
+}
+
+/*************
+ * TRANSPORT *
+ *************/
+let port;
+
+if (config.transport === "serial") {
+    port = new osc.SerialPort({
+        devicePath: config.serialPath,
+        bitrate: config.serialBaud,
+        metadata: true
+    });
+} else {
+    port = new osc.UDPPort({
+        localAddress: "0.0.0.0",
+        localPort: config.localPort,
+        remoteAddress: config.host,
+        remotePort: config.port,
+        metadata: true
+    });
+}
+
+port.on("error", function (err) {
+    console.log(err);
+});
+
+/*************
+ * RESPONDER *
+ *************/
+// Same behavior as MicroOsc::replyToPing(): used to measure the harness itself over loopback UDP or a pty pair.
+function respond(oscMessage, timeTag, info) {
+    if (oscMessage.address !== "/microosc/ping") return;
+    let pong = { address: "/microosc/pong", args: oscMessage.args };
+    if (info && info.address) port.send(pong, info.address, info.port);
+    else port.send(pong);
+}
+
+/**************
+ * CLOCK SYNC *
+ **************/
+// Answers MicroOscClock::sendPing() with t1 (echoed), t2 (receive time) and t3 (send time).
+const { performance } = require("perf_hooks");
+const NTP_EPOCH_OFFSET = 2208988800; // seconds from 1900 to 1970
+
+function ntpTimeTag() {
+    let ms = performance.timeOrigin + performance.now();
+    let seconds = Math.floor(ms / 1000);
+    return { raw: [seconds + NTP_EPOCH_OFFSET, Math.floor((ms - seconds * 1000) / 1000 * 4294967296)] };
+}
+
+function answerClockPing(oscMessage, info) {
+    let t2 = ntpTimeTag();
+    let pong = {
+        address: "/microosc/clock/pong",
+        args: [oscMessage.args[0], { type: "t", value: t2 }, { type: "t", value: ntpTimeTag() }]
+    };
+    if (info && info.address) port.send(pong, info.address, info.port);
+    else port.send(pong);
+}
+
+/**********
+ * DRIVER *
+ **********/
+let payload = new Uint8Array(config.payload);
+let sent = new Map();   // sequence number -> send time (ns)
+let latencies = [];     // microseconds, in sequence order
+let lost = 0;
+let sequence = 0;
+let total = config.warmup + config.count;
+
+function nowTimeTag() {
+    let ms = Date.now();
+    return osc.timeTag(0, ms);
+}
+
+function sendPing() {
+    let args = [
+        { type: "i", value: sequence },
+        { type: "t", value: nowTimeTag() }
+    ];
+    if (config.payload > 0) args.push({ type: "b", value: payload });
+
+    sent.set(sequence, process.hrtime.bigint());
+    port.send({ address: "/microosc/ping", args: args });
+    sequence++;
+}
+
+function receivePong(oscMessage) {
+    if (oscMessage.address !== "/microosc/pong") return;
+    let received = process.hrtime.bigint();
+    let seq = oscMessage.args[0].value;
+    let start = sent.get(seq);
+    if (start === undefined) return; // late or duplicate
+    sent.delete(seq);
+    if (seq >= config.warmup) latencies.push(Number(received - start) / 1000);
+}
+
+function expireLost() {
+    let limit = process.hrtime.bigint() - BigInt(config.timeout) * 1000000n;
+    sent.forEach(function (start, seq) {
+        if (start < limit) {
+            sent.delete(seq);
+            if (seq >= config.warmup) lost++;
+        }
+    });
+}
+
+function percentile(sorted, p) {
+    if (sorted.length === 0) return NaN;
+    let index = Math.min(sorted.length - 1, Math.ceil(p / 100 * sorted.length) - 1);
+    return sorted[Math.max(0, index)];
+}
+
+// Log2 buckets in microseconds
+function printHistogram(title, values) {
+    let buckets = [];
+    values.forEach(function (v) {
+        let b = v < 1 ? 0 : Math.floor(Math.log2(v)) + 1;
+        buckets[b] = (buckets[b] || 0) + 1;
+    });
+    let max = Math.max.apply(null, buckets.filter(function (n) { return n; }));
+    console.log("\n" + title + " (us)");
+    for (let b = 0; b < buckets.length; b++) {
+        let n = buckets[b] || 0;
+        let low = b === 0 ? 0 : Math.pow(2, b - 1);
+        let label = (low + "-" + Math.pow(2, b)).padStart(16);
+        console.log(label + " | " + "#".repeat(Math.round(n / max * 50)) + " " + n);
+    }
+}
+
+function report() {
+    let sorted = latencies.slice().sort(function (a, b) { return a - b; });
+    // Jitter: difference between consecutive latencies (RFC 3550 style)
+    let jitter = [];
+    for (let i = 1; i < latencies.length; i++) jitter.push(Math.abs(latencies[i] - latencies[i - 1]));
+    let sortedJitter = jitter.slice().sort(function (a, b) { return a - b; });
+    let mean = latencies.reduce(function (a, b) { return a + b; }, 0) / latencies.length;
+
+    console.log("\n**** MicroOsc round-trip latency ****");
+    console.log("* Transport: " + config.transport + ", rate: " + config.rate + "/s, payload: " + config.payload + " bytes");
+    console.log("* Received: " + latencies.length + ", lost: " + lost);
+    console.log("* min: " + sorted[0].toFixed(1) + " us, mean: " + mean.toFixed(1) + " us, max: " + sorted[sorted.length - 1].toFixed(1) + " us");
+    console.log("* p50: " + percentile(sorted, 50).toFixed(1) + " us");
+    console.log("* p99: " + percentile(sorted, 99).toFixed(1) + " us");
+    console.log("* p99.9: " + percentile(sorted, 99.9).toFixed(1) + " us");
+    console.log("* jitter p50: " + percentile(sortedJitter, 50).toFixed(1) + " us, p99: " + percentile(sortedJitter, 99).toFixed(1) + " us");
+    printHistogram("Latency", latencies);
+    printHistogram("Jitter", jitter);
+
+    if (config.maxP99 > 0 && percentile(sorted, 99) > config.maxP99) {
+        console.log("\np99 is above the limit of " + config.maxP99 + " us");
+        return 1;
+    }
+    return 0;
+}
+
+function finish() {
+    port.close();
+    if (latencies.length === 0) {
+        console.log("No pong received.");
+        process.exit(1);
+    }
+    process.exit(report());
+}
+
+function runDriver() {
+    let interval = setInterval(function () {
+        expireLost();
+        if (sequence < total) {
+            sendPing();
+        } else if (sent.size === 0) {
+            clearInterval(interval);
+            finish();
+        }
+    }, 1000 / config.rate);
+}
+
+port.on("message", function (oscMessage, timeTag, info) {
+    if (oscMessage.address === "/microosc/clock/ping") answerClockPing(oscMessage, info);
+    else if (config.responder) respond(oscMessage, timeTag, info);
+    else receivePong(oscMessage);
+});
+
+port.on("ready", function () {
+    if (config.responder) {
+        console.log("Answering /microosc/ping over " + config.transport);
+    } else {
+        console.log("Sending " + total + " pings over " + config.transport);
+        runDriver();
+    }
+});
+
+port.open();
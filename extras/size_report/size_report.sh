@@ -0,0 +1,39 @@
+#!/bin/sh
+# Prints the flash and RAM used by a sketch for each MicroOsc configuration (see src/MicroOscConfig.h).
+# usage: extras/size_report/size_report.sh [sketch folder] [fqbn]
+# Requires arduino-cli with the core of the board installed.
+
+LIBRARY=$(cd "$(dirname "$0")/../.." && pwd)
+SKETCH=${1:-$LIBRARY/examples/microosc_slip_multiple-arguments}
+FQBN=${2:-arduino:avr:uno}
+
+ALL="-DMICRO_OSC_NO_DOUBLE -DMICRO_OSC_NO_INT64 -DMICRO_OSC_NO_BLOB -DMICRO_OSC_NO_MIDI -DMICRO_OSC_NO_BUNDLES -DMICRO_OSC_NO_SOURCE_CALLBACK \
+  -DMICRO_OSC_NO_QUEUE -DMICRO_OSC_NO_COALESCER -DMICRO_OSC_NO_CAPTURE"
+
+report() {
+  # $1: name of the configuration, $2: compiler flags
+  OUTPUT=$(arduino-cli compile --clean --fqbn "$FQBN" --library "$LIBRARY" \
+    --build-property "compiler.cpp.extra_flags=$2" "$SKETCH" 2>&1)
+  if [ $? -ne 0 ]; then
+    printf "%-24s %10s\n" "$1" "FAILED"
+    echo "$OUTPUT" | grep -m 5 "error"
+    return
+  fi
+  FLASH=$(echo "$OUTPUT" | sed -n 's/^Sketch uses \([0-9]*\) bytes.*/\1/p')
+  RAM=$(echo "$OUTPUT" | sed -n 's/^Global variables use \([0-9]*\) bytes.*/\1/p')
+  printf "%-24s %10s %10s\n" "$1" "$FLASH" "$RAM"
+}
+
+echo "$(basename "$SKETCH") on $FQBN"
+printf "%-24s %10s %10s\n" "configuration" "flash" "RAM"
+report "default" ""
+report "NO_DOUBLE" "-DMICRO_OSC_NO_DOUBLE"
+report "NO_INT64" "-DMICRO_OSC_NO_INT64"
+report "NO_BLOB" "-DMICRO_OSC_NO_BLOB"
+report "NO_MIDI" "-DMICRO_OSC_NO_MIDI"
+report "NO_BUNDLES" "-DMICRO_OSC_NO_BUNDLES"
+report "NO_SOURCE_CALLBACK" "-DMICRO_OSC_NO_SOURCE_CALLBACK"
+report "NO_QUEUE" "-DMICRO_OSC_NO_QUEUE"
+report "NO_COALESCER" "-DMICRO_OSC_NO_COALESCER"
+report "NO_CAPTURE" "-DMICRO_OSC_NO_CAPTURE"
+report "all of the above" "$ALL"
@@ -16,6 +16,9 @@
 #include "MicroOscUtility.h"
 
 #include "MicroOsc.h"
+#ifndef MICRO_OSC_NO_CAPTURE
+#include "MicroOscCapture.h"
+#endif
 
 /* void MicroOsc::pad() {
   while ( (outputWritten % 4 ) ) {
@@ -55,6 +58,25 @@ void MicroOsc::writeFormat(const char *format) {
 
 }
 
+// Writes ",[" followed by count times type and "]"
+void MicroOsc::writeArrayFormat(char type, size_t count) {
+  uint8_t tags[16];
+  memset(tags, type, sizeof(tags));
+  output->write(',');
+  output->write('[');
+  for (size_t left = count; left > 0; ) {
+    size_t n = ( left < sizeof(tags) ) ? left : sizeof(tags);
+    output->write(tags, n);
+    left -= n;
+  }
+  output->write(']');
+  output->write(nullChar);
+  outputWritten += count + 4;
+  // pad the size
+  pad();
+
+}
+
 void MicroOsc::messageAddInt(int32_t int32) {
   int32_t networkInt32 = swapBigEndian32(int32);
   //int32_t v32 = htonl(v);
@@ -64,18 +86,25 @@ void MicroOsc::messageAddInt(int32_t int32) {
 }
 
 void MicroOsc::messageAddFloat(float f) {
-  float v32 = swapBigEndian32(f);
+  // swap the bits of the float, not its value converted to an integer
+  int32_t i32;
+  memcpy(&i32, &f, 4);
+  int32_t v32 = swapBigEndian32(i32);
   uint8_t * ptr = (uint8_t *) &v32;
   output->write(ptr, 4);
   outputWritten += 4;
 }
 
+#ifndef MICRO_OSC_NO_DOUBLE
 void MicroOsc::messageAddDouble(double d) {
-  double v64 = swapBigEndian64(d);
+  int64_t i64 = 0;
+  memcpy(&i64, &d, sizeof(double));
+  int64_t v64 = swapBigEndian64(i64);
   uint8_t * ptr = (uint8_t *) &v64;
   output->write(ptr, sizeof(double));
   outputWritten += sizeof(double);
 }
+#endif
 
 void MicroOsc::messageAddString(const char *str) {
 
@@ -87,6 +116,7 @@ void MicroOsc::messageAddString(const char *str) {
 
 }
 
+#ifndef MICRO_OSC_NO_BLOB
 void MicroOsc::messageAddBlob( const uint8_t * b, int32_t length) {
   // Replace following three lines with messageAddInt
   uint32_t n32 = swapBigEndian32(length);
@@ -97,18 +127,59 @@ void MicroOsc::messageAddBlob( const uint8_t * b, int32_t length) {
   // pad the size
   pad();
 }
+#endif
+
+#ifndef MICRO_OSC_NO_MIDI
 void MicroOsc::messageAddMidi(const unsigned char *midi) {
   output->write(midi, 4);
   outputWritten += 4;
 }
+#endif
 
+#ifndef MICRO_OSC_NO_INT64
 void MicroOsc::messageAddInt64(uint64_t h) {
   const uint64_t tBE = swapBigEndian64(h);
   uint8_t * ptr = (uint8_t *) &tBE;
   output->write(ptr, 8);
   outputWritten += 8;
 }
+#endif
+
+
+void MicroOsc::messageAddTimetag(uint64_t t) {
+  const uint64_t tBE = swapBigEndian64(t);
+  uint8_t * ptr = (uint8_t *) &tBE;
+  output->write(ptr, 8);
+  outputWritten += 8;
+}
+
+// Values are swapped in chunks so the output gets a few large writes
+#define MICRO_OSC_ARRAY_CHUNK 16
+
+void MicroOsc::messageAddIntArray(const int32_t *values, size_t count) {
+  int32_t chunk[MICRO_OSC_ARRAY_CHUNK];
+  while ( count > 0 ) {
+    size_t n = ( count < MICRO_OSC_ARRAY_CHUNK ) ? count : MICRO_OSC_ARRAY_CHUNK;
+    for (size_t i = 0; i < n; i++) chunk[i] = swapBigEndian32(values[i]);
+    output->write((const uint8_t *)chunk, n * 4);
+    outputWritten += n * 4;
+    values += n;
+    count -= n;
+  }
+}
 
+void MicroOsc::messageAddFloatArray(const float *values, size_t count) {
+  int32_t chunk[MICRO_OSC_ARRAY_CHUNK];
+  while ( count > 0 ) {
+    size_t n = ( count < MICRO_OSC_ARRAY_CHUNK ) ? count : MICRO_OSC_ARRAY_CHUNK;
+    memcpy(chunk, values, n * 4);
+    for (size_t i = 0; i < n; i++) chunk[i] = swapBigEndian32(chunk[i]);
+    output->write((const uint8_t *)chunk, n * 4);
+    outputWritten += n * 4;
+    values += n;
+    count -= n;
+  }
+}
 
 
 void MicroOsc::writeMessage( const char *address, const char *format, va_list ap) {
@@ -125,6 +196,7 @@ void MicroOsc::writeMessage( const char *address, const char *format, va_list ap
       messageAddInt(int32);
       break;
     }
+#ifndef MICRO_OSC_NO_BLOB
     case 'b': {
 
       unsigned char *b = (unsigned char *) va_arg(ap, void *); // pointer to binary data
@@ -133,6 +205,7 @@ void MicroOsc::writeMessage( const char *address, const char *format, va_list ap
 
       break;
     }
+#endif
 
     case 's': {
       const char *str = (const char *) va_arg(ap, void *);
@@ -149,33 +222,45 @@ void MicroOsc::writeMessage( const char *address, const char *format, va_list ap
       break;
     }
 
+#ifndef MICRO_OSC_NO_DOUBLE
     case 'd': {
       double  d = (double) va_arg(ap, double);//const float v = (float) va_arg(ap, double);
       messageAddDouble(d);
       break;
     }
+#endif
 
+#ifndef MICRO_OSC_NO_MIDI
     case 'm': {
       // get unsigned char array of size 4
       const unsigned char *const midi = (unsigned char *) va_arg(ap, void *);
       messageAddMidi(midi);
       break;
     }
+#endif
 
+#ifndef MICRO_OSC_NO_INT64
     case 'h': {
       const uint64_t h = (uint64_t) va_arg(ap, long long);
       messageAddInt64(h);
       break;
     }
+#endif
+    case 't': {
+      const uint64_t t = (uint64_t) va_arg(ap, uint64_t);
+      messageAddTimetag(t);
+      break;
+    }
     case 'T': // true
     case 'F': // false
     case 'N': // nil
-    case 'I': {  // Impulse
+    case 'I':    // Impulse
+    case '[':    // array begin
+    case ']': {  // array end
       // No argument
       break;
     }
 
-    case 't': // osc timetag
     default:
       // unsupported type, force an error (length will not be a multiple of 4)
       output->write(nullChar);
@@ -190,56 +275,381 @@ void MicroOsc::writeMessage( const char *address, const char *format, va_list ap
 
 MicroOsc::MicroOsc(Print* output) {
   this->output = output;
+  this->transportOutput = output;
+#ifndef MICRO_OSC_NO_BUNDLES
+  bundleOutput.osc = this;
+#endif
 };
 
 
+// Every message goes through three stages:
+// outputBegin()/outputEnd() : the message, staged in the bundle buffer when batching
+// packetBegin()/packetEnd() : the packet (message or bundle), encoded in the transmit queue when there is one
+// transportBegin()/transportEnd() : the transport
+
+void MicroOsc::packetBegin() {
+#ifndef MICRO_OSC_NO_QUEUE
+  if ( queue ) {
+    queue->beginFrame(transmitPriority);
+    output = queue;
+    return;
+  }
+#endif
+  transportBegin();
+  output = transportOutput;
+}
+
+void MicroOsc::packetEnd() {
+  output = transportOutput;
+#ifndef MICRO_OSC_NO_QUEUE
+  if ( queue ) {
+    queue->endFrame();
+    drainQueue();
+    return;
+  }
+#endif
+  transportEnd();
+}
+
+#ifdef MICRO_OSC_NO_BUNDLES
+
+void MicroOsc::outputBegin() {
+  packetBegin();
+}
+
+void MicroOsc::outputEnd() {
+  packetEnd();
+}
+
+#else
+
+void MicroOsc::outputBegin() {
+  if ( bundleBuffer && (autoBatch || bundleOpen) ) {
+    if ( bundleLength == 0 ) {
+      // '#bundle' , timetag
+      memcpy(bundleBuffer, "#bundle", 8);
+      const uint64_t tBE = swapBigEndian64(bundleTimetag);
+      memcpy(bundleBuffer + 8, &tBE, 8);
+      bundleLength = 16;
+      bundleStarted = micros();
+    }
+    bundleElementStart = bundleLength;
+    bundleLength += 4; // the size of the element, written by outputEnd()
+    output = &bundleOutput;
+  } else {
+    packetBegin();
+  }
+}
+
+void MicroOsc::outputEnd() {
+  if ( output != &bundleOutput ) {
+    packetEnd();
+    return;
+  }
+
+  output = transportOutput;
+  if ( bundleDirect ) {
+    // the message did not fit in the bundle buffer and was sent on its own
+    bundleDirect = false;
+    packetEnd();
+  } else {
+    const int32_t sizeBE = swapBigEndian32(bundleLength - bundleElementStart - 4);
+    memcpy(bundleBuffer + bundleElementStart, &sizeBE, 4);
+    bundleCount++;
+  }
+  if ( autoBatch && !bundleOpen && (micros() - bundleStarted) >= bundleDeadline ) flush();
+}
+
+size_t MicroOsc::bundleWrite(const uint8_t *data, size_t length) {
+  if ( bundleDirect ) return directOutput->write(data, length);
+
+  if ( bundleLength + length <= bundleSize ) {
+    memcpy(bundleBuffer + bundleLength, data, length);
+    bundleLength += length;
+    return length;
+  }
+
+  // the message being written does not fit: send the complete elements and keep the partial one
+  const size_t partial = bundleLength - bundleElementStart - 4;
+  if ( bundleCount > 0 ) {
+    sendBundle(bundleElementStart);
+    memmove(bundleBuffer + 20, bundleBuffer + bundleElementStart + 4, partial);
+    bundleElementStart = 16;
+    bundleLength = 20 + partial;
+    bundleStarted = micros();
+    if ( bundleLength + length <= bundleSize ) {
+      memcpy(bundleBuffer + bundleLength, data, length);
+      bundleLength += length;
+      return length;
+    }
+  }
+
+  // the message is larger than the bundle buffer: send it on its own, outside of a bundle
+  bundleDirect = true;
+  bundleLength = 0;
+  packetBegin();
+  directOutput = output;
+  output = &bundleOutput; // for outputEnd()
+  directOutput->write(bundleBuffer + bundleElementStart + 4, partial);
+  return directOutput->write(data, length);
+}
+
+void MicroOsc::sendBundle(size_t length) {
+  Print *messageOutput = output;
+  if ( bundleCount == 1 && autoBatch && !bundleOpen ) {
+    // a single message is sent without the bundle header
+    packetBegin();
+    output->write(bundleBuffer + 20, length - 20);
+    packetEnd();
+  } else {
+    packetBegin();
+    output->write(bundleBuffer, length);
+    packetEnd();
+  }
+  output = messageOutput;
+  bundleCount = 0;
+  bundleLength = 0;
+}
+
+void MicroOsc::setBundleBuffer(unsigned char *buffer, size_t size) {
+  flush();
+  // room for the bundle header and the size of one element
+  bundleBuffer = (size > 20) ? buffer : NULL;
+  bundleSize = size;
+}
+
+void MicroOsc::setAutoBatch(bool enabled, uint32_t deadlineMicros) {
+  if ( !enabled ) flush();
+  autoBatch = enabled;
+  bundleDeadline = deadlineMicros;
+}
+
+void MicroOsc::bundleBegin(uint64_t timetag) {
+  flush();
+  bundleOpen = true;
+  bundleTimetag = timetag;
+}
+
+void MicroOsc::bundleEnd() {
+  bundleOpen = false;
+  flush();
+  bundleTimetag = OSC_TIMETAG_IMMEDIATELY;
+}
+
+void MicroOsc::flush() {
+  if ( bundleCount > 0 ) sendBundle(bundleLength);
+  bundleLength = 0;
+}
+
+#endif // MICRO_OSC_NO_BUNDLES
+
+#ifndef MICRO_OSC_NO_QUEUE
+void MicroOsc::setTransmitQueue(MicroOscQueue *queue) {
+#ifndef MICRO_OSC_NO_BUNDLES
+  flush();
+#endif
+  this->queue = queue;
+}
+#endif
+
+void MicroOsc::update() {
+#ifndef MICRO_OSC_NO_BUNDLES
+  if ( autoBatch && !bundleOpen && bundleCount > 0 && (micros() - bundleStarted) >= bundleDeadline ) flush();
+#endif
+#ifndef MICRO_OSC_NO_QUEUE
+  if ( queue ) drainQueue();
+#endif
+}
+
+#ifndef MICRO_OSC_NO_QUEUE
+void MicroOsc::drainQueue() {
+  size_t budget = transportAvailableForWrite();
+
+  while ( budget > 0 ) {
+    bool starting = !queue->isReading();
+    if ( queue->beginRead() == 0 ) return;
+    if ( starting ) transportBegin();
+
+    const uint8_t *data;
+    size_t length = queue->peekRead(&data);
+    if ( length > budget ) length = budget;
+    transportOutput->write(data, length);
+    transportWritten(length);
+    budget -= length;
+
+    if ( queue->consume(length) ) {
+      transportEnd();
+      // asked again after each packet: a transport such as the shm ring takes a whole slot per packet
+      budget = transportAvailableForWrite();
+    }
+  }
+}
+#endif
+
+
+
+
+
+#ifndef MICRO_OSC_NO_COALESCER
+void MicroOsc::setCoalescer(MicroOscCoalescer *coalescer) {
+  this->coalescer = coalescer;
+}
+#endif
+
+template <class Policy>
+void MicroOsc::deliver(MicroOscCallback callback) {
+#ifndef MICRO_OSC_NO_COALESCER
+  if ( coalescer ) {
+    if ( coalescer->store(message, timetag) ) return;
+    // no room left: dispatch the messages kept so far and try again
+    dispatchCoalesced<Policy>(callback);
+    if ( coalescer->store(message, timetag) ) return;
+  }
+#endif
+  callback(message);
+}
 
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+template <class Policy>
+void MicroOsc::deliver(MicroOscCallbackWithSource callback) {
+#ifndef MICRO_OSC_NO_COALESCER
+  if ( coalescer ) {
+    if ( coalescer->store(message, timetag) ) return;
+    dispatchCoalesced<Policy>(callback);
+    if ( coalescer->store(message, timetag) ) return;
+  }
+#endif
+  callback(*this, message);
+}
+#endif
+
+#ifndef MICRO_OSC_NO_COALESCER
+// The kept messages are parsed in their own MicroOscMessage: message can be the one being stored
+template <class Policy>
+void MicroOsc::dispatchCoalesced(MicroOscCallback callback) {
+  if ( coalescer == NULL ) return;
+  unsigned char *parsedPacket = packet;
+  size_t parsedPacketLength = packetLength;
+  uint64_t parsedTimetag = timetag;
+  for (size_t i = 0; i < coalescer->count(); i++) {
+    MicroOscMessage kept;
+    packet = coalescer->getMessage(i, &packetLength);
+    timetag = coalescer->getTimetag(i);
+    if ( kept.parseMessage<Policy>(packet, packetLength) == 0 ) callback(kept);
+  }
+  coalescer->clear();
+  packet = parsedPacket;
+  packetLength = parsedPacketLength;
+  timetag = parsedTimetag;
+}
 
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+template <class Policy>
+void MicroOsc::dispatchCoalesced(MicroOscCallbackWithSource callback) {
+  if ( coalescer == NULL ) return;
+  unsigned char *parsedPacket = packet;
+  size_t parsedPacketLength = packetLength;
+  uint64_t parsedTimetag = timetag;
+  for (size_t i = 0; i < coalescer->count(); i++) {
+    MicroOscMessage kept;
+    packet = coalescer->getMessage(i, &packetLength);
+    timetag = coalescer->getTimetag(i);
+    if ( kept.parseMessage<Policy>(packet, packetLength) == 0 ) callback(*this, kept);
+  }
+  coalescer->clear();
+  packet = parsedPacket;
+  packetLength = parsedPacketLength;
+  timetag = parsedTimetag;
+}
+#endif
+#endif // MICRO_OSC_NO_COALESCER
 
 // http://opensoundcontrol.org/spec-1_0
+template <class Policy>
 void MicroOsc::parseMessages(MicroOscCallback callback, unsigned char *buffer, const size_t bufferLength) {
 
   if ( callback == NULL ) return;
 
+  packet = buffer;
+  packetLength = bufferLength;
+  packetsReceived++;
+#ifndef MICRO_OSC_NO_CAPTURE
+  if ( capture ) capture->record(buffer, bufferLength);
+#endif
+
+#ifdef MICRO_OSC_NO_BUNDLES
+  // an address starts with '/', a bundle with '#'
+  bool isBundle = ( bufferLength > 0 && buffer[0] == '#' );
+  if ( !isBundle && message.parseMessage<Policy>(buffer, bufferLength) == 0 ) {
+    deliver<Policy>(callback);
+  }
+#else
   // Check for bundles
-  if (isABundle(buffer)) {
+  if (isABundle<Policy>(buffer, bufferLength)) {
     parseBundle(buffer, bufferLength);
     timetag = parseBundleTimeTag();
     //isPartOfABundle = true;
-    while ( getNextMessage()) {
-      callback(message);
+    int result;
+    while ( (result = getNextMessage<Policy>()) != 0 ) {
+      if ( result > 0 ) deliver<Policy>(callback);
     }
   } else {
     timetag = 0;
     //isPartOfABundle = false;
-    if ( message.parseMessage(buffer, bufferLength) == 0 ) {
-      callback(message);
+    if ( message.parseMessage<Policy>(buffer, bufferLength) == 0 ) {
+      deliver<Policy>(callback);
     }
   }
+#endif
 
+  // forwardPacket() is only valid in the callback, the buffer belongs to the transport
+  packet = NULL;
+  packetLength = 0;
 }
 
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+template <class Policy>
 void MicroOsc::parseMessages(MicroOscCallbackWithSource callback, unsigned char *buffer, const size_t bufferLength) {
 
   if ( callback == NULL ) return;
 
+  packet = buffer;
+  packetLength = bufferLength;
+  packetsReceived++;
+#ifndef MICRO_OSC_NO_CAPTURE
+  if ( capture ) capture->record(buffer, bufferLength);
+#endif
+
+#ifdef MICRO_OSC_NO_BUNDLES
+  // an address starts with '/', a bundle with '#'
+  bool isBundle = ( bufferLength > 0 && buffer[0] == '#' );
+  if ( !isBundle && message.parseMessage<Policy>(buffer, bufferLength) == 0 ) {
+    deliver<Policy>(callback);
+  }
+#else
   // Check for bundles
-  if (isABundle(buffer)) {
+  if (isABundle<Policy>(buffer, bufferLength)) {
     parseBundle(buffer, bufferLength);
     timetag = parseBundleTimeTag();
     //isPartOfABundle = true;
-    while ( getNextMessage()) {
-      callback(*this, message);
+    int result;
+    while ( (result = getNextMessage<Policy>()) != 0 ) {
+      if ( result > 0 ) deliver<Policy>(callback);
     }
   } else {
     timetag = 0;
     //isPartOfABundle = false;
-    if ( message.parseMessage(buffer, bufferLength) == 0 ) {
-      callback(*this, message);
+    if ( message.parseMessage<Policy>(buffer, bufferLength) == 0 ) {
+      deliver<Policy>(callback);
     }
   }
+#endif
 
+  // forwardPacket() is only valid in the callback, the buffer belongs to the transport
+  packet = NULL;
+  packetLength = 0;
 }
+#endif
 
 
 
@@ -249,14 +659,21 @@ void MicroOsc::parseMessages(MicroOscCallbackWithSource callback, unsigned char
         uint8_t * ptr = (uint8_t *) &v64;
     */
 
+#ifndef MICRO_OSC_NO_BUNDLES
 uint64_t MicroOsc::parseBundleTimeTag() {
-  uint64_t timeTag = *((uint64_t *) (bundle.buffer + 8));
+  uint64_t timeTag;
+  memcpy(&timeTag, bundle.buffer + 8, 8);
   return swapBigEndian64(timeTag);
 }
 
 
 // check if first eight bytes are '#bundle '
-bool MicroOsc::isABundle(const unsigned char  *buffer) {
+template <class Policy>
+bool MicroOsc::isABundle(const unsigned char  *buffer, const size_t bufferLength) {
+  if ( Policy::checked ) {
+    // '#bundle', its null terminator and the timetag
+    return bufferLength >= 16 && memcmp(buffer, "#bundle", 8) == 0;
+  }
   return (strcmp( (const char*)buffer, "#bundle") == 0); //return ((*(const int64_t *) buffer) == htonll(BUNDLE_ID));
 }
 
@@ -272,34 +689,102 @@ void MicroOsc::parseBundle(unsigned char  *buffer, const size_t bufferLength) {
 
 
 
-bool MicroOsc::getNextMessage() {
-  if ((int32_t)(bundle.marker - bundle.buffer) >= bundle.bundleLen) return false;
+template <class Policy>
+int MicroOsc::getNextMessage() {
+  if ((int32_t)(bundle.marker - bundle.buffer) >= bundle.bundleLen) return 0;
+
+  const uint32_t remaining = bundle.bundleLen - (bundle.marker - bundle.buffer);
+  if ( Policy::checked && remaining < 4 ) {
+    // truncated bundle, ignore the rest
+    bundle.marker = bundle.buffer + bundle.bundleLen;
+    return 0;
+  }
 
-  uint32_t lenBE = *((uint32_t *) bundle.marker);
+  uint32_t lenBE;
+  memcpy(&lenBE, bundle.marker, 4);
   uint32_t bufferLength = swapBigEndian32(lenBE);
 
-  message.parseMessage(bundle.marker + 4, bufferLength);
+  if ( Policy::checked && bufferLength > remaining - 4 ) {
+    bundle.marker = bundle.buffer + bundle.bundleLen;
+    return 0;
+  }
+
+  int result = message.parseMessage<Policy>(bundle.marker + 4, bufferLength);
   bundle.marker += (4 + bufferLength); // move marker to next bundle element
-  return true;
+  return ( result == 0 ) ? 1 : -1;
 }
+#endif
+
+template void MicroOsc::parseMessages<MicroOscChecked>(MicroOscCallback callback, unsigned char *buffer, const size_t bufferLength);
+template void MicroOsc::parseMessages<MicroOscUnchecked>(MicroOscCallback callback, unsigned char *buffer, const size_t bufferLength);
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+template void MicroOsc::parseMessages<MicroOscChecked>(MicroOscCallbackWithSource callback, unsigned char *buffer, const size_t bufferLength);
+template void MicroOsc::parseMessages<MicroOscUnchecked>(MicroOscCallbackWithSource callback, unsigned char *buffer, const size_t bufferLength);
+#endif
+#ifndef MICRO_OSC_NO_COALESCER
+template void MicroOsc::dispatchCoalesced<MicroOscChecked>(MicroOscCallback callback);
+template void MicroOsc::dispatchCoalesced<MicroOscUnchecked>(MicroOscCallback callback);
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+template void MicroOsc::dispatchCoalesced<MicroOscChecked>(MicroOscCallbackWithSource callback);
+template void MicroOsc::dispatchCoalesced<MicroOscUnchecked>(MicroOscCallbackWithSource callback);
+#endif
+#endif
+
 
 void MicroOsc::sendMessage(const char *address, const char *format, ...) {
   if ( transportReady() ) {
-    transportBegin();
+    outputBegin();
     va_list ap;
     va_start(ap, format);
     writeMessage( address, format, ap);
     va_end(ap);
-    transportEnd();
+    outputEnd();
+  }
+}
+
+void MicroOsc::sendRaw(const unsigned char *buffer, size_t length) {
+  if ( transportReady() ) {
+    outputBegin();
+    output->write(buffer, length);
+    outputEnd();
+  }
+}
+
+void MicroOsc::forwardPacket(MicroOsc &source) {
+  if ( source.packet == NULL ) return;
+  sendRaw(source.packet, source.packetLength);
+}
+
+void MicroOsc::forwardMessage(const MicroOscMessage &msg) {
+  sendRaw(msg.buffer_, msg.buffer_length_);
+}
+
+void MicroOsc::forwardMessage(const MicroOscMessage &msg, const char *address) {
+  // everything from the comma that starts the type tags to the end of the message is copied as is
+  const unsigned char *typeTags = (const unsigned char *) msg.format_ - 1;
+  const size_t typeTagsOffset = typeTags - msg.buffer_;
+  if ( typeTagsOffset >= msg.buffer_length_ ) return;
+
+  if ( transportReady() ) {
+    outputBegin();
+    writeAddress(address);
+    output->write(typeTags, msg.buffer_length_ - typeTagsOffset);
+    outputEnd();
   }
 }
 
+bool MicroOsc::replyToPing(const MicroOscMessage &msg) {
+  if ( strcmp((const char *) msg.buffer_, "/microosc/ping") != 0 ) return false;
+  forwardMessage(msg, "/microosc/pong");
+  return true;
+}
+
 void MicroOsc::sendWithoutArguments(const char *address, const char * type) {
   if ( transportReady() ) {
-    transportBegin();
+    outputBegin();
     writeAddress(address);
     writeFormat(type);
-    transportEnd();
+    outputEnd();
   }
 }
 
@@ -322,71 +807,108 @@ void MicroOsc::sendNull(const char *address) {
 
 void MicroOsc::sendInt(const char *address, int32_t i) {
   if ( transportReady() ) {
-    transportBegin();
+    outputBegin();
     writeAddress(address);
     writeFormat("i");
     messageAddInt(i);
-    transportEnd();
+    outputEnd();
+  }
+}
+
+void MicroOsc::sendIntArray(const char *address, const int32_t *values, size_t count) {
+  if ( transportReady() ) {
+    outputBegin();
+    writeAddress(address);
+    writeArrayFormat('i', count);
+    messageAddIntArray(values, count);
+    outputEnd();
+  }
+}
+
+void MicroOsc::sendFloatArray(const char *address, const float *values, size_t count) {
+  if ( transportReady() ) {
+    outputBegin();
+    writeAddress(address);
+    writeArrayFormat('f', count);
+    messageAddFloatArray(values, count);
+    outputEnd();
   }
 }
 
 void MicroOsc::sendFloat(const char *address, float f) {
   if ( transportReady() ) {
-    transportBegin();
+    outputBegin();
     writeAddress(address);
     writeFormat("f");
     messageAddFloat(f);
-    transportEnd();
+    outputEnd();
   }
 }
 
 void MicroOsc::sendString(const char *address, const char *str) {
   if ( transportReady() ) {
-    transportBegin();
+    outputBegin();
     writeAddress(address);
     writeFormat("s");
     messageAddString(str);
-    transportEnd();
+    outputEnd();
   }
 }
 
+#ifndef MICRO_OSC_NO_BLOB
 void MicroOsc::sendBlob(const char *address, const uint8_t *b, int32_t length) {
   if ( transportReady() ) {
-    transportBegin();
+    outputBegin();
     writeAddress(address);
     writeFormat("b");
     messageAddBlob(b, length);
-    transportEnd();
+    outputEnd();
   }
 }
+#endif
 
+#ifndef MICRO_OSC_NO_DOUBLE
 void MicroOsc::sendDouble(const char *address, double d) {
   if ( transportReady() ) {
-    transportBegin();
+    outputBegin();
     writeAddress(address);
     writeFormat("d");
     messageAddDouble(d);
-    transportEnd();
+    outputEnd();
   }
 }
+#endif
 
+#ifndef MICRO_OSC_NO_MIDI
 void MicroOsc::sendMidi(const char *address, unsigned char *midi) {
   if ( transportReady() ) {
-    transportBegin();
+    outputBegin();
     writeAddress(address);
     writeFormat("m");
     messageAddMidi(midi);
-    transportEnd();
+    outputEnd();
   }
 }
+#endif
 
+#ifndef MICRO_OSC_NO_INT64
 void MicroOsc::sendInt64(const char *address, uint64_t h) {
   if ( transportReady() ) {
-    transportBegin();
+    outputBegin();
     writeAddress(address);
     writeFormat("h");
     messageAddInt64(h);
-    transportEnd();
+    outputEnd();
   }
 }
+#endif
 
+void MicroOsc::sendTimetag(const char *address, uint64_t t) {
+  if ( transportReady() ) {
+    outputBegin();
+    writeAddress(address);
+    writeFormat("t");
+    messageAddTimetag(t);
+    outputEnd();
+  }
+}
@@ -12,16 +12,35 @@
 #include <stdarg.h>
 
 #include "Print.h"
+#include "MicroOscConfig.h"
 #include "MicroOscMessage.h"
+#ifndef MICRO_OSC_NO_QUEUE
+#include "MicroOscQueue.h"
+#endif
+#ifndef MICRO_OSC_NO_COALESCER
+#include "MicroOscCoalescer.h"
+#endif
+
+// Maximum number of packets a transport reads in one call of onOscMessageReceived() when a coalescer is set
+#ifndef MICRO_OSC_DRAIN_LIMIT
+#define MICRO_OSC_DRAIN_LIMIT 32
+#endif
+
+#ifndef MICRO_OSC_NO_CAPTURE
+class MicroOscCapture; // FORWARD DECLARATION;
+#endif
 
 class MicroOsc
 {
 
 public:
 	typedef void (*MicroOscCallback)(MicroOscMessage &msg);
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
 	typedef void (*MicroOscCallbackWithSource)(MicroOsc &source, MicroOscMessage &msg);
+#endif
 
 private:
+#ifndef MICRO_OSC_NO_BUNDLES
 	struct uOscBundle
 	{
 		unsigned char *marker; // the current write head (where the next message will be written)
@@ -30,14 +49,57 @@ private:
 		int32_t bundleLen; // the byte length of the total bundle
 	};
 	struct uOscBundle bundle;
+#endif
 	MicroOscMessage message;
-	uint64_t timetag;
+	unsigned char *packet = NULL; // the packet currently being parsed
+	size_t packetLength = 0;
+	uint64_t timetag = 0;
 	const uint8_t nullChar = '\0';
 	Print *output;
+	Print *transportOutput; // the output of the transport, output points to the queue while queueing
 	uint32_t outputWritten = 0;
+#ifndef MICRO_OSC_NO_QUEUE
+	MicroOscQueue *queue = NULL;
+	uint8_t transmitPriority = MICRO_OSC_PRIORITY_CONTROL;
+#endif
+#ifndef MICRO_OSC_NO_CAPTURE
+	MicroOscCapture *capture = NULL;
+#endif
+	uint32_t packetsReceived = 0;
+
+#ifndef MICRO_OSC_NO_BUNDLES
+	// Writes the message being encoded in the bundle buffer
+	class BundleOutput : public Print
+	{
+	public:
+		MicroOsc *osc;
+		size_t write(uint8_t b) override
+		{
+			return osc->bundleWrite(&b, 1);
+		}
+		size_t write(const uint8_t *buffer, size_t size) override
+		{
+			return osc->bundleWrite(buffer, size);
+		}
+	};
+	BundleOutput bundleOutput;
+	unsigned char *bundleBuffer = NULL; // the bundle being staged
+	size_t bundleSize = 0;
+	size_t bundleLength = 0;       // bytes staged, header included
+	size_t bundleElementStart = 0; // offset of the size of the element being written
+	uint16_t bundleCount = 0;      // complete elements staged
+	uint64_t bundleTimetag = 1;    // immediately
+	bool bundleOpen = false;       // between bundleBegin() and bundleEnd()
+	bool bundleDirect = false;     // the message being written is larger than the buffer and bypasses it
+	Print *directOutput = NULL;
+	bool autoBatch = false;
+	uint32_t bundleDeadline = 0;
+	unsigned long bundleStarted = 0;
+#endif
 
 
 private:
+#ifndef MICRO_OSC_NO_BUNDLES
 	uint64_t parseBundleTimeTag();
 
 	void parseBundle(unsigned char *buffer, const size_t len);
@@ -45,28 +107,77 @@ private:
 	/**
 	 * Returns true if the message is a bundle. False otherwise.
 	 */
-	bool isABundle(const unsigned char *buffer);
+	template <class Policy>
+	bool isABundle(const unsigned char *buffer, const size_t len);
 
 	/**
-	 * Parses the next message in a bundle. Returns true if successful.
-	 * False otherwise.
+	 * Parses the next message in a bundle. Returns 1 if successful,
+	 * -1 if the element is not a valid message and 0 at the end of the bundle.
 	 */
-	bool getNextMessage();
+	template <class Policy>
+	int getNextMessage();
+#endif
 
 protected:
 	void pad();
 	void writeAddress(const char *address);
 	void writeFormat(const char *format);
+	void writeArrayFormat(char type, size_t count);
 
 
 private:
 	void writeMessage(const char *address, const char *format, va_list ap);
 	void sendWithoutArguments(const char *address, const char *type);
+	void outputBegin();
+	void outputEnd();
+	void packetBegin();
+	void packetEnd();
+#ifndef MICRO_OSC_NO_QUEUE
+	void drainQueue();
+#endif
+#ifndef MICRO_OSC_NO_BUNDLES
+	size_t bundleWrite(const uint8_t *data, size_t length);
+	void sendBundle(size_t length);
+#endif
+	template <class Policy>
+	void deliver(MicroOscCallback callback);
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+	template <class Policy>
+	void deliver(MicroOscCallbackWithSource callback);
+#endif
 
 protected:
+#ifndef MICRO_OSC_NO_COALESCER
+	MicroOscCoalescer *coalescer = NULL;
+#endif
+	uint8_t receiveBudget = 0; // packets per call of onOscMessageReceived(), 0 for the default of the transport
+
+	/**
+	 * Returns true if another packet can be handled after received packets in this call of onOscMessageReceived().
+	 */
+	bool receiveBudgetLeft(size_t received)
+	{
+		return receiveBudget == 0 || received < receiveBudget;
+	}
+
 	virtual void transportBegin() = 0;
 	virtual void transportEnd() = 0;
 	virtual bool transportReady() = 0;
+#ifndef MICRO_OSC_NO_QUEUE
+	/**
+	 * Returns the number of bytes the transport can accept without blocking. Only used when a transmit queue is set.
+	 */
+	virtual size_t transportAvailableForWrite()
+	{
+		return SIZE_MAX;
+	}
+	/**
+	 * Called after length bytes of the transmit queue were written to the transport.
+	 */
+	virtual void transportWritten(size_t)
+	{
+	}
+#endif
 
 public:
 	/*!
@@ -78,39 +189,218 @@ public:
 	 * Parse a buffer containing an OSC message or OSC bundle.
 	 * The contents of the buffer are NOT copied.
 	 * Calls the callback for every message received in a bundle or not.
+	 * The Policy (MicroOscChecked or MicroOscUnchecked) sets the checks done while parsing.
 	 */
+	template <class Policy = MicroOscChecked>
 	void parseMessages(MicroOscCallback callback, unsigned char *buffer, const size_t len);
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+	template <class Policy = MicroOscChecked>
 	void parseMessages(MicroOscCallbackWithSource callback, unsigned char *buffer, const size_t len);
+#endif
+
+#ifndef MICRO_OSC_NO_CAPTURE
+	/**
+	 * Record every packet given to parseMessages() in capture. Set to NULL to stop recording.
+	 */
+	void setCapture(MicroOscCapture *capture)
+	{
+		this->capture = capture;
+	}
+#endif
+
+#ifndef MICRO_OSC_NO_COALESCER
+	/**
+	 * Keep only the newest message per address of the packets received by one call of onOscMessageReceived(),
+	 * then call the callback for those messages. Set to NULL to call the callback for every message (the default).
+	 */
+	void setCoalescer(MicroOscCoalescer *coalescer);
+#endif
+
+	/**
+	 * Limits the number of packets handled by one call of onOscMessageReceived(), so a busy transport
+	 * does not starve the others (see MicroOscHub). 0 for the default: every packet already received
+	 * for SLIP and shared memory, one datagram for UDP (MICRO_OSC_DRAIN_LIMIT with a coalescer).
+	 */
+	void setReceiveBudget(uint8_t packets)
+	{
+		receiveBudget = packets;
+	}
+
+	uint8_t getReceiveBudget()
+	{
+		return receiveBudget;
+	}
+
+	/**
+	 * Returns the number of packets given to parseMessages() since the start.
+	 */
+	uint32_t getReceivedPacketCount()
+	{
+		return packetsReceived;
+	}
+
+	/**
+	 * Calls the callback for the messages kept by the coalescer and empties it.
+	 * getBundleTimetag() returns the timetag of the bundle each message came from.
+	 * Called by the transports at the end of onOscMessageReceived(), with the policy of the transport.
+	 */
+#ifndef MICRO_OSC_NO_COALESCER
+	template <class Policy = MicroOscChecked>
+	void dispatchCoalesced(MicroOscCallback callback);
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+	template <class Policy = MicroOscChecked>
+	void dispatchCoalesced(MicroOscCallbackWithSource callback);
+#endif
+#else
+	template <class Policy = MicroOscChecked>
+	void dispatchCoalesced(MicroOscCallback)
+	{
+	}
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+	template <class Policy = MicroOscChecked>
+	void dispatchCoalesced(MicroOscCallbackWithSource)
+	{
+	}
+#endif
+#endif
+
+	/**
+	 * Returns the timetag of the bundle being parsed, 0 if the message is not part of a bundle.
+	 */
+	uint64_t getBundleTimetag()
+	{
+		return timetag;
+	}
 
 	void messageAddInt(int32_t i);
 	void messageAddFloat(float f);
 	void messageAddString(const char *str);
+#ifndef MICRO_OSC_NO_BLOB
 	void messageAddBlob(const uint8_t *b, int32_t length);
+#endif
+#ifndef MICRO_OSC_NO_DOUBLE
 	void messageAddDouble(double d);
+#endif
+#ifndef MICRO_OSC_NO_MIDI
 	void messageAddMidi(const unsigned char *midi);
+#endif
+#ifndef MICRO_OSC_NO_INT64
 	void messageAddInt64(uint64_t h);
+#endif
+	void messageAddTimetag(uint64_t t);
+	/**
+	 * Add count elements at once, for a format with '[' and ']' around them ("[ffff]").
+	 */
+	void messageAddIntArray(const int32_t *values, size_t count);
+	void messageAddFloatArray(const float *values, size_t count);
 
 	void messageBegin(const char *address, const char *format)
 	{
-		transportBegin();
+		outputBegin();
 		writeAddress(address);
 		writeFormat(format);
 	}
 
 	void messageEnd()
 	{
-		transportEnd();
+		outputEnd();
+	}
+
+#ifndef MICRO_OSC_NO_QUEUE
+	/**
+	 * Encode outgoing messages into a transmit queue instead of writing them to the transport.
+	 * The queue is sent only as fast as the transport accepts it without blocking, by update().
+	 * Set to NULL to write directly to the transport again (the default).
+	 */
+	void setTransmitQueue(MicroOscQueue *queue);
+
+	/**
+	 * Sets the priority class (MICRO_OSC_PRIORITY_CONTROL or MICRO_OSC_PRIORITY_BULK) of the following messages.
+	 * Queued control messages are sent before queued bulk messages.
+	 */
+	void setTransmitPriority(uint8_t priority)
+	{
+		transmitPriority = priority;
+	}
+#endif
+
+	/**
+	 * Sends as much of the transmit queue as the transport accepts without blocking,
+	 * and sends the automatic batch if its deadline is over.
+	 * Called by onOscMessageReceived(), call it in loop() if you do not receive messages.
+	 */
+	void update();
+
+#ifndef MICRO_OSC_NO_BUNDLES
+	/**
+	 * Sets the buffer used to write bundles (with bundleBegin() or setAutoBatch()).
+	 * size is the largest packet that will be sent (for example the MTU for UDP).
+	 */
+	void setBundleBuffer(unsigned char *buffer, size_t size);
+
+	/**
+	 * When enabled, consecutive messages accumulate into one bundle in the bundle buffer.
+	 * The bundle is sent when the next message does not fit, when deadlineMicros is over, or on flush().
+	 * A batch of a single message is sent as a message.
+	 */
+	void setAutoBatch(bool enabled, uint32_t deadlineMicros = 1000);
+
+	/**
+	 * Following messages are written in one bundle (split if it does not fit the bundle buffer) until bundleEnd().
+	 * Requires a bundle buffer, messages are sent one by one otherwise.
+	 */
+	void bundleBegin(uint64_t timetag = 1);
+	void bundleEnd();
+
+	/**
+	 * Returns true between bundleBegin() and bundleEnd().
+	 */
+	bool isBundleOpen()
+	{
+		return bundleOpen;
 	}
 
+	/**
+	 * Sends the messages accumulated in the bundle buffer.
+	 */
+	void flush();
+#endif
+
 	/**
 	 * Check for messages and execute callback for every received message
 	 */
 	virtual void onOscMessageReceived(MicroOscCallback callback) = 0;
 
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
 	/**
 	 * Check for messages and execute callback for every received message
 	 */
 	virtual void onOscMessageReceived(MicroOscCallbackWithSource callback) = 0;
+#endif
+
+	/**
+	 * Send an already encoded OSC packet (message or bundle) without any modification.
+	 */
+	void sendRaw(const unsigned char *buffer, size_t length);
+	/**
+	 * Forward the packet (message or whole bundle) currently being parsed by source without decoding it.
+	 * Only valid inside of the function called by `onOscMessageReceived()` of source.
+	 */
+	void forwardPacket(MicroOsc &source);
+	/**
+	 * Forward a received message (or a single bundle element) without decoding it.
+	 */
+	void forwardMessage(const MicroOscMessage &msg);
+	/**
+	 * Forward a received message, replacing its address. The type tags and arguments are copied unchanged.
+	 */
+	void forwardMessage(const MicroOscMessage &msg, const char *address);
+
+	/**
+	 * Answers latency measurement pings: if msg is a `/microosc/ping`, sends it back unchanged
+	 * (arguments included) as a `/microosc/pong` and returns true. Returns false otherwise.
+	 */
+	bool replyToPing(const MicroOscMessage &msg);
 
 	/**
 	 * Send an OSC message with any mnumber of arguments of diffrent types
@@ -144,22 +434,42 @@ public:
 	 * Send a single string OSC message
 	 */
 	void sendString(const char *address, const char *str);
+#ifndef MICRO_OSC_NO_BLOB
 	/**
 	 * Send a single blob (array of bytes) OSC message
 	 */
 	void sendBlob(const char *address, const uint8_t *b, int32_t length);
+#endif
+#ifndef MICRO_OSC_NO_DOUBLE
 	/**
 	 * Send a single double OSC message
 	 */
 	void sendDouble(const char *address, double d);
+#endif
+#ifndef MICRO_OSC_NO_MIDI
 	/**
 	 * Send a single MIDI OSC message
 	 */
 	void sendMidi(const char *address, unsigned char *midi);
+#endif
+#ifndef MICRO_OSC_NO_INT64
 	/**
 	 * Send a single Int64 OSC message
 	 */
 	void sendInt64(const char *address, uint64_t h);
+#endif
+	/**
+	 * Send a single timetag OSC message
+	 */
+	void sendTimetag(const char *address, uint64_t t);
+	/**
+	 * Send a message with a single array of ints (type tags ",[iii...]")
+	 */
+	void sendIntArray(const char *address, const int32_t *values, size_t count);
+	/**
+	 * Send a message with a single array of floats (type tags ",[fff...]")
+	 */
+	void sendFloatArray(const char *address, const float *values, size_t count);
 };
 
 #endif // _MICRO_OSC_
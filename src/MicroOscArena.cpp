@@ -0,0 +1,98 @@
+#include "MicroOscArena.h"
+
+// Every message is stored as a 32-bit length followed by the message padded to a multiple of 4 bytes.
+// A length of MICRO_OSC_ARENA_WRAP means that the next message is at the beginning of the buffer.
+#define MICRO_OSC_ARENA_WRAP 0xFFFFFFFFUL
+#define MICRO_OSC_ARENA_HEADER_SIZE 4
+
+MicroOscArena::MicroOscArena(void *buffer, size_t size)
+{
+  buffer_ = (unsigned char *)buffer;
+  size_ = size & ~0x3;
+}
+
+MicroOscRetained MicroOscArena::retain(const MicroOscMessage &msg)
+{
+  return retain(msg.getRawMessage(), msg.getRawMessageLength());
+}
+
+MicroOscRetained MicroOscArena::retain(const unsigned char *message, size_t length)
+{
+  MicroOscRetained retained = {NULL, 0};
+  const size_t block = MICRO_OSC_ARENA_HEADER_SIZE + ((length + 3) & ~0x3);
+
+  size_t position;
+  size_t skipped = 0;
+  if (count_ == 0)
+  {
+    head_ = 0;
+    tail_ = 0;
+  }
+  if (head_ >= tail_ && !(head_ == tail_ && count_ > 0))
+  {
+    // free space from head to the end and from the beginning to tail
+    if (size_ - head_ >= block)
+    {
+      position = head_;
+    }
+    else if (tail_ >= block)
+    {
+      skipped = size_ - head_;
+      position = 0;
+    }
+    else
+    {
+      return retained;
+    }
+  }
+  else
+  {
+    // free space from head to tail
+    if (tail_ - head_ < block)
+      return retained;
+    position = head_;
+  }
+
+  if (skipped >= MICRO_OSC_ARENA_HEADER_SIZE)
+    *((uint32_t *)(buffer_ + head_)) = MICRO_OSC_ARENA_WRAP;
+
+  *((uint32_t *)(buffer_ + position)) = length;
+  memcpy(buffer_ + position + MICRO_OSC_ARENA_HEADER_SIZE, message, length);
+  head_ = (position + block) % size_;
+  count_++;
+
+  retained.data = buffer_ + position + MICRO_OSC_ARENA_HEADER_SIZE;
+  retained.length = length;
+  return retained;
+}
+
+MicroOscRetained MicroOscArena::oldest()
+{
+  MicroOscRetained retained = {NULL, 0};
+  if (count_ == 0)
+    return retained;
+  if (size_ - tail_ < MICRO_OSC_ARENA_HEADER_SIZE || *((uint32_t *)(buffer_ + tail_)) == MICRO_OSC_ARENA_WRAP)
+  {
+    tail_ = 0;
+  }
+  retained.length = *((uint32_t *)(buffer_ + tail_));
+  retained.data = buffer_ + tail_ + MICRO_OSC_ARENA_HEADER_SIZE;
+  return retained;
+}
+
+void MicroOscArena::release()
+{
+  MicroOscRetained retained = oldest();
+  if (!retained.isValid())
+    return;
+  const size_t block = MICRO_OSC_ARENA_HEADER_SIZE + ((retained.length + 3) & ~0x3);
+  tail_ = (tail_ + block) % size_;
+  count_--;
+}
+
+void MicroOscArena::clear()
+{
+  head_ = 0;
+  tail_ = 0;
+  count_ = 0;
+}
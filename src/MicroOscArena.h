@@ -0,0 +1,109 @@
+/* MicroOscArena
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_ARENA_
+#define _MICRO_OSC_ARENA_
+
+#include <Arduino.h>
+#include "MicroOscMessage.h"
+
+/**
+ * A message retained in a MicroOscArena. Parse it with parse() the same way as a received message.
+ * Valid until it is released from its arena.
+ */
+struct MicroOscRetained
+{
+	unsigned char *data;
+	size_t length;
+
+	bool isValid() const
+	{
+		return data != NULL;
+	}
+
+	/**
+	 * Parses the retained message into msg. Returns 0 if there is no error, like MicroOscMessage::parseMessage().
+	 */
+	int parse(MicroOscMessage &msg) const
+	{
+		if (data == NULL)
+			return -1;
+		return msg.parseMessage(data, length);
+	}
+};
+
+/**
+ * First in, first out arena of copied messages.
+ * retain() copies the raw bytes of a message with a single memcpy and no heap allocation,
+ * release() frees the oldest retained message.
+ * Not thread safe: retain() and release() must be called from the same thread, or core.
+ * Use MicroOscMessageArena<SIZE> to reserve the memory.
+ */
+class MicroOscArena
+{
+	unsigned char *buffer_;
+	size_t size_;
+	size_t head_ = 0; // where the next message is copied
+	size_t tail_ = 0; // the oldest message
+	size_t count_ = 0;
+
+public:
+	/**
+	 * buffer must be aligned on 4 bytes.
+	 */
+	MicroOscArena(void *buffer, size_t size);
+
+	/**
+	 * Copies the message in the arena.
+	 * Returns an invalid MicroOscRetained (isValid() is false) if there is not enough room.
+	 */
+	MicroOscRetained retain(const MicroOscMessage &msg);
+
+	/**
+	 * Copies an encoded message in the arena.
+	 */
+	MicroOscRetained retain(const unsigned char *message, size_t length);
+
+	/**
+	 * Returns the oldest retained message, an invalid one if the arena is empty.
+	 */
+	MicroOscRetained oldest();
+
+	/**
+	 * Frees the oldest retained message.
+	 */
+	void release();
+
+	/**
+	 * Frees every retained message.
+	 */
+	void clear();
+
+	bool isEmpty()
+	{
+		return count_ == 0;
+	}
+
+	/**
+	 * Returns the number of retained messages.
+	 */
+	size_t count()
+	{
+		return count_;
+	}
+};
+
+template <const size_t SIZE>
+class MicroOscMessageArena : public MicroOscArena
+{
+protected:
+	uint32_t storage_[(SIZE + 3) / 4];
+
+public:
+	MicroOscMessageArena() : MicroOscArena(storage_, sizeof(storage_))
+	{
+	}
+};
+
+#endif // _MICRO_OSC_ARENA_
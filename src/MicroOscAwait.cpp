@@ -0,0 +1,189 @@
+#include "MicroOscAwait.h"
+
+#ifdef MICRO_OSC_COROUTINES
+
+#include <new>
+
+/***********
+  FRAME POOL
+************/
+
+MicroOscFramePool::MicroOscFramePool(void *slots, size_t slotSize, size_t count)
+{
+  slots_ = (unsigned char *)slots;
+  slot_size_ = slotSize;
+  count_ = count;
+  for (size_t i = count; i > 0; i--)
+  {
+    Slot *slot = (Slot *)(slots_ + (i - 1) * slot_size_);
+    slot->next = free_;
+    free_ = slot;
+  }
+}
+
+void *MicroOscFramePool::allocate(size_t size)
+{
+  if (size > slot_size_ || free_ == NULL)
+    return NULL;
+  Slot *slot = free_;
+  free_ = slot->next;
+  used_++;
+  return slot;
+}
+
+bool MicroOscFramePool::deallocate(void *pointer)
+{
+  unsigned char *p = (unsigned char *)pointer;
+  if (p < slots_ || p >= slots_ + slot_size_ * count_)
+    return false;
+  Slot *slot = (Slot *)p;
+  slot->next = free_;
+  free_ = slot;
+  used_--;
+  return true;
+}
+
+/***********
+  TASK
+************/
+
+static MicroOscFramePool *microOscFramePool = NULL;
+
+// Every frame starts with the pool it comes from (NULL for the heap), so the pool can change while tasks run
+static const size_t MICRO_OSC_FRAME_HEADER = alignof(max_align_t);
+
+void MicroOscTask::setFramePool(MicroOscFramePool *pool)
+{
+  microOscFramePool = pool;
+}
+
+void *MicroOscTask::promise_type::operator new(size_t size)
+{
+  MicroOscFramePool *pool = microOscFramePool;
+  void *block = (pool != NULL) ? pool->allocate(size + MICRO_OSC_FRAME_HEADER) : NULL;
+  if (block == NULL)
+  {
+    pool = NULL;
+    block = ::operator new(size + MICRO_OSC_FRAME_HEADER);
+  }
+  *(MicroOscFramePool **)block = pool;
+  return (unsigned char *)block + MICRO_OSC_FRAME_HEADER;
+}
+
+void MicroOscTask::promise_type::operator delete(void *pointer)
+{
+  void *block = (unsigned char *)pointer - MICRO_OSC_FRAME_HEADER;
+  MicroOscFramePool *pool = *(MicroOscFramePool **)block;
+  if (pool == NULL || !pool->deallocate(block))
+    ::operator delete(block);
+}
+
+/***********
+  AWAITER
+************/
+
+void MicroOscAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+  handle_ = handle;
+  start_ = millis();
+  async_->enqueue(this);
+}
+
+/***********
+  EXECUTOR
+************/
+
+MicroOscAsync *MicroOscAsync::current_ = NULL;
+
+MicroOscAsync::~MicroOscAsync()
+{
+  while (head_ != NULL)
+  {
+    MicroOscAwaiter *awaiter = head_;
+    unlink(awaiter, NULL);
+    // the awaiter is in the frame being destroyed
+    awaiter->handle_.destroy();
+  }
+}
+
+void MicroOscAsync::enqueue(MicroOscAwaiter *awaiter)
+{
+  awaiter->next_ = NULL;
+  if (tail_ != NULL)
+    tail_->next_ = awaiter;
+  else
+    head_ = awaiter;
+  tail_ = awaiter;
+  waiting_++;
+}
+
+void MicroOscAsync::unlink(MicroOscAwaiter *awaiter, MicroOscAwaiter *previous)
+{
+  if (previous != NULL)
+    previous->next_ = awaiter->next_;
+  else
+    head_ = awaiter->next_;
+  if (tail_ == awaiter)
+    tail_ = previous;
+  waiting_--;
+}
+
+void MicroOscAsync::dispatch(MicroOscMessage &msg)
+{
+  MicroOscAwaiter *previous = NULL;
+  for (MicroOscAwaiter *awaiter = head_; awaiter != NULL; awaiter = awaiter->next_)
+  {
+    if (awaiter->address_ == NULL || msg.checkOscAddress(awaiter->address_))
+    {
+      unlink(awaiter, previous);
+      awaiter->message_ = &msg;
+      // runs until the next co_await of the coroutine, the message is valid until then
+      awaiter->handle_.resume();
+      return;
+    }
+    previous = awaiter;
+  }
+  if (handler_ != NULL)
+    handler_(msg);
+}
+
+void MicroOscAsync::onMessage(MicroOscMessage &msg)
+{
+  current_->dispatch(msg);
+}
+
+void MicroOscAsync::expire()
+{
+  unsigned long now = millis();
+  // resuming a coroutine can change the list, so start over after each one
+  bool expired = true;
+  while (expired)
+  {
+    expired = false;
+    MicroOscAwaiter *previous = NULL;
+    for (MicroOscAwaiter *awaiter = head_; awaiter != NULL; awaiter = awaiter->next_)
+    {
+      // an awaiter queued by a resumed coroutine started after now: the signed difference is negative
+      if (awaiter->timeout_ > 0 && (long)(now - awaiter->start_) >= (long)awaiter->timeout_)
+      {
+        unlink(awaiter, previous);
+        awaiter->message_ = NULL;
+        awaiter->handle_.resume();
+        expired = true;
+        break;
+      }
+      previous = awaiter;
+    }
+  }
+}
+
+void MicroOscAsync::update()
+{
+  MicroOscAsync *updating = current_;
+  current_ = this;
+  osc_.onOscMessageReceived(onMessage);
+  current_ = updating;
+  expire();
+}
+
+#endif // MICRO_OSC_COROUTINES
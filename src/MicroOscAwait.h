@@ -0,0 +1,237 @@
+/* MicroOscAwait
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_AWAIT_
+#define _MICRO_OSC_AWAIT_
+
+#include <MicroOsc.h>
+
+// C++20 coroutines (hosts, ESP-IDF with -std=gnu++20)
+#if defined(__has_include)
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#define MICRO_OSC_COROUTINES
+#endif
+#endif
+
+#ifdef MICRO_OSC_COROUTINES
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+class MicroOscAsync; // FORWARD DECLARATION;
+
+/**
+ * Fixed size slots for the frames of MicroOscTask coroutines, so starting a task does not use the heap.
+ * A frame larger than a slot (see getSlotSize()), or started when every slot is used, is allocated on the heap.
+ * Use MicroOscTaskFrames<SLOT_SIZE, COUNT> to reserve the memory.
+ */
+class MicroOscFramePool
+{
+	struct Slot
+	{
+		Slot *next;
+	};
+	unsigned char *slots_;
+	size_t slot_size_;
+	size_t count_;
+	Slot *free_ = NULL;
+	size_t used_ = 0;
+
+public:
+	MicroOscFramePool(void *slots, size_t slotSize, size_t count);
+
+	void *allocate(size_t size);
+
+	/**
+	 * Returns false if pointer is not a slot of this pool.
+	 */
+	bool deallocate(void *pointer);
+
+	size_t getUsedCount()
+	{
+		return used_;
+	}
+
+	size_t getSlotSize()
+	{
+		return slot_size_;
+	}
+};
+
+template <const size_t SLOT_SIZE, const size_t COUNT>
+class MicroOscTaskFrames : public MicroOscFramePool
+{
+	static const size_t ALIGNED_SIZE = (SLOT_SIZE + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+	alignas(max_align_t) unsigned char slots_[ALIGNED_SIZE * COUNT];
+
+public:
+	MicroOscTaskFrames() : MicroOscFramePool(slots_, ALIGNED_SIZE, COUNT)
+	{
+	}
+};
+
+/**
+ * Return type of a coroutine that awaits OSC messages. The coroutine starts when it is called,
+ * runs until its first co_await, and is resumed by MicroOscAsync::update() until it returns.
+ * Nothing has to keep the task: its frame is freed when the coroutine returns.
+ */
+class MicroOscTask
+{
+public:
+	struct promise_type
+	{
+		MicroOscTask get_return_object()
+		{
+			return MicroOscTask();
+		}
+		std::suspend_never initial_suspend() noexcept
+		{
+			return {};
+		}
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+		void return_void()
+		{
+		}
+		void unhandled_exception()
+		{
+			std::terminate();
+		}
+
+		static void *operator new(size_t size);
+		static void operator delete(void *pointer);
+	};
+
+	/**
+	 * Frames of the tasks started after this call are taken from pool. NULL to use the heap (the default).
+	 */
+	static void setFramePool(MicroOscFramePool *pool);
+};
+
+/**
+ * What co_await waits for: the next message, or the next message with an address.
+ * The awaiter lives in the frame of the coroutine, so awaiting does not allocate anything.
+ */
+class MicroOscAwaiter
+{
+	friend MicroOscAsync;
+
+	MicroOscAsync *async_;
+	const char *address_; // NULL for any address
+	uint32_t timeout_;	  // milliseconds, 0 for no timeout
+	unsigned long start_ = 0;
+	std::coroutine_handle<> handle_;
+	MicroOscMessage *message_ = NULL;
+	MicroOscAwaiter *next_ = NULL;
+
+public:
+	MicroOscAwaiter(MicroOscAsync *async, const char *address, uint32_t timeoutMillis)
+		: async_(async), address_(address), timeout_(timeoutMillis)
+	{
+	}
+
+	bool await_ready()
+	{
+		return false;
+	}
+
+	void await_suspend(std::coroutine_handle<> handle);
+
+	/**
+	 * Returns the message, or NULL if the timeout is over.
+	 */
+	MicroOscMessage *await_resume()
+	{
+		return message_;
+	}
+};
+
+/**
+ * Single-threaded executor of coroutines that await the messages received by a MicroOsc:
+ *
+ *   MicroOscTask query(MicroOscAsync &async) {
+ *     myMicroOsc.sendInt("/query", 1);
+ *     MicroOscMessage *reply = co_await async.expect("/reply", 100);
+ *     if (reply) { int32_t value = reply->nextAsInt(); }
+ *   }
+ *
+ * update() receives the messages and resumes the coroutines. Each message resumes the oldest coroutine
+ * waiting for it (so replies match the queries in order), or is given to the handler if none is waiting.
+ * A received message is only valid until the next co_await.
+ */
+class MicroOscAsync
+{
+	friend MicroOscAwaiter;
+
+	MicroOsc &osc_;
+	MicroOsc::MicroOscCallback handler_ = NULL;
+	MicroOscAwaiter *head_ = NULL;
+	MicroOscAwaiter *tail_ = NULL;
+	size_t waiting_ = 0;
+
+	static MicroOscAsync *current_; // the executor being updated
+
+private:
+	void enqueue(MicroOscAwaiter *awaiter);
+	void unlink(MicroOscAwaiter *awaiter, MicroOscAwaiter *previous);
+	void dispatch(MicroOscMessage &msg);
+	void expire();
+	static void onMessage(MicroOscMessage &msg);
+
+public:
+	MicroOscAsync(MicroOsc &osc) : osc_(osc)
+	{
+	}
+
+	/**
+	 * Destroys the coroutines that are still waiting.
+	 */
+	~MicroOscAsync();
+
+	/**
+	 * co_await next() returns the next message, or NULL after timeoutMillis (0 waits forever).
+	 */
+	MicroOscAwaiter next(uint32_t timeoutMillis = 0)
+	{
+		return MicroOscAwaiter(this, NULL, timeoutMillis);
+	}
+
+	/**
+	 * co_await expect(address) returns the next message with this address, or NULL after timeoutMillis (0 waits forever).
+	 * address must stay valid while waiting.
+	 */
+	MicroOscAwaiter expect(const char *address, uint32_t timeoutMillis = 0)
+	{
+		return MicroOscAwaiter(this, address, timeoutMillis);
+	}
+
+	/**
+	 * Sets the function called for the messages no coroutine waits for.
+	 */
+	void setHandler(MicroOsc::MicroOscCallback handler)
+	{
+		handler_ = handler;
+	}
+
+	/**
+	 * Receives the messages, resumes the coroutines waiting for them and those whose timeout is over.
+	 * Call it in loop().
+	 */
+	void update();
+
+	/**
+	 * Returns the number of coroutines waiting.
+	 */
+	size_t getWaitingCount()
+	{
+		return waiting_;
+	}
+};
+
+#endif // MICRO_OSC_COROUTINES
+
+#endif // _MICRO_OSC_AWAIT_
@@ -0,0 +1,196 @@
+#include "MicroOscCapture.h"
+
+#ifndef MICRO_OSC_NO_CAPTURE
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static void writeLittleEndian32(Print *log, uint32_t value)
+{
+  uint8_t bytes[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+  log->write(bytes, 4);
+}
+
+static uint32_t readLittleEndian32(const unsigned char *bytes)
+{
+  return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+MicroOscCapture::MicroOscCapture(Print *log)
+{
+  log_ = log;
+}
+
+MicroOscCapture::MicroOscCapture(Print &log)
+{
+  log_ = &log;
+}
+
+void MicroOscCapture::begin()
+{
+  log_->write((const uint8_t *)MICRO_OSC_CAPTURE_MAGIC, MICRO_OSC_CAPTURE_HEADER_SIZE);
+}
+
+void MicroOscCapture::record(const unsigned char *packet, size_t length)
+{
+  static const uint8_t zeroPad[4] = {0, 0, 0, 0};
+  writeLittleEndian32(log_, micros());
+  writeLittleEndian32(log_, length);
+  log_->write(packet, length);
+  uint8_t pad = (4 - (length % 4)) % 4;
+  if (pad)
+    log_->write(zeroPad, pad);
+}
+
+MicroOscReplay::MicroOscReplay()
+{
+  capture_ = NULL;
+  capture_length_ = 0;
+  marker_ = 0;
+}
+
+bool MicroOscReplay::begin(unsigned char *capture, size_t length)
+{
+#if defined(__linux__)
+  close();
+#endif
+  return attach(capture, length);
+}
+
+bool MicroOscReplay::attach(unsigned char *capture, size_t length)
+{
+  if (length < MICRO_OSC_CAPTURE_HEADER_SIZE || memcmp(capture, MICRO_OSC_CAPTURE_MAGIC, MICRO_OSC_CAPTURE_HEADER_SIZE) != 0)
+  {
+    capture_ = NULL;
+    capture_length_ = 0;
+    marker_ = 0;
+    return false;
+  }
+  capture_ = capture;
+  capture_length_ = length;
+  marker_ = MICRO_OSC_CAPTURE_HEADER_SIZE;
+  elapsed_ = 0;
+  record_time_ = 0;
+  last_micros_ = micros();
+  if (marker_ + MICRO_OSC_CAPTURE_RECORD_HEADER_SIZE <= capture_length_)
+    previous_stamp_ = readLittleEndian32(capture_ + marker_);
+  return true;
+}
+
+#if defined(__linux__)
+bool MicroOscReplay::open(const char *path)
+{
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    ::close(fd);
+    return false;
+  }
+  // private writable mapping : parseMessages() takes a non-const buffer, the file is never modified
+  void *map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED)
+    return false;
+  if (!attach((unsigned char *)map, st.st_size))
+  {
+    munmap(map, st.st_size);
+    return false;
+  }
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+  mapped_ = true;
+  return true;
+}
+
+void MicroOscReplay::close()
+{
+  if (mapped_)
+    munmap(capture_, capture_length_);
+  mapped_ = false;
+  capture_ = NULL;
+  capture_length_ = 0;
+  marker_ = 0;
+}
+
+MicroOscReplay::~MicroOscReplay()
+{
+  close();
+}
+#endif
+
+unsigned char *MicroOscReplay::nextDuePacket(size_t *length)
+{
+  if (marker_ + MICRO_OSC_CAPTURE_RECORD_HEADER_SIZE > capture_length_)
+  {
+    marker_ = capture_length_;
+    return NULL;
+  }
+
+  unsigned char *record = capture_ + marker_;
+  uint32_t stamp = readLittleEndian32(record);
+  uint32_t packetLength = readLittleEndian32(record + 4);
+  size_t recordLength = MICRO_OSC_CAPTURE_RECORD_HEADER_SIZE + ((packetLength + 3) & ~0x3);
+  if (packetLength > capture_length_ || marker_ + recordLength > capture_length_)
+  {
+    // truncated capture
+    marker_ = capture_length_;
+    return NULL;
+  }
+
+  if (speed_ > 0)
+  {
+    // the difference handles the wrap around of micros() during the capture
+    uint64_t due = record_time_ + (uint32_t)(stamp - previous_stamp_);
+    if ((double)elapsed_ * speed_ < (double)due)
+      return NULL;
+    record_time_ = due;
+  }
+  previous_stamp_ = stamp;
+
+  marker_ += recordLength;
+  *length = packetLength;
+  return record + MICRO_OSC_CAPTURE_RECORD_HEADER_SIZE;
+}
+
+bool MicroOscReplay::update(MicroOsc &osc, MicroOsc::MicroOscCallback callback)
+{
+  unsigned long now = micros();
+  elapsed_ += (unsigned long)(now - last_micros_);
+  last_micros_ = now;
+
+  size_t length;
+  unsigned char *packet;
+  while ((packet = nextDuePacket(&length)) != NULL)
+  {
+    osc.parseMessages(callback, packet, length);
+  }
+  osc.dispatchCoalesced(callback);
+  return !isFinished();
+}
+
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+bool MicroOscReplay::update(MicroOsc &osc, MicroOsc::MicroOscCallbackWithSource callback)
+{
+  unsigned long now = micros();
+  elapsed_ += (unsigned long)(now - last_micros_);
+  last_micros_ = now;
+
+  size_t length;
+  unsigned char *packet;
+  while ((packet = nextDuePacket(&length)) != NULL)
+  {
+    osc.parseMessages(callback, packet, length);
+  }
+  osc.dispatchCoalesced(callback);
+  return !isFinished();
+}
+#endif
+
+#endif // MICRO_OSC_NO_CAPTURE
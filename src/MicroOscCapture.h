@@ -0,0 +1,129 @@
+/* MicroOscCapture
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_CAPTURE_
+#define _MICRO_OSC_CAPTURE_
+
+#include <Arduino.h>
+#include "Print.h"
+#include "MicroOsc.h"
+
+#ifndef MICRO_OSC_NO_CAPTURE
+
+/*
+ Capture format (all integers are little-endian):
+ - 8 bytes header: "MOSCCAP1"
+ - one record per packet:
+   - uint32 : micros() when the packet was received
+   - uint32 : length of the packet in bytes
+   - the packet, padded with zeros to a multiple of 4 bytes
+*/
+#define MICRO_OSC_CAPTURE_MAGIC "MOSCCAP1"
+#define MICRO_OSC_CAPTURE_HEADER_SIZE 8
+#define MICRO_OSC_CAPTURE_RECORD_HEADER_SIZE 8
+
+/**
+ * Appends every received packet to a binary log (a file, Serial...), with its reception time.
+ */
+class MicroOscCapture
+{
+	Print *log_;
+
+public:
+	MicroOscCapture(Print *log);
+	MicroOscCapture(Print &log);
+
+	/**
+	 * Writes the capture header. Call once at the beginning of a new log.
+	 */
+	void begin();
+
+	/**
+	 * Appends a packet to the log. Called by MicroOsc::parseMessages() when the capture is set with MicroOsc::setCapture().
+	 */
+	void record(const unsigned char *packet, size_t length);
+};
+
+/**
+ * Feeds the packets of a capture back through MicroOsc::parseMessages(), at their original timing,
+ * at a multiple of their original speed, or as fast as possible.
+ * The capture is read in place and is NOT copied.
+ */
+class MicroOscReplay
+{
+	unsigned char *capture_;
+	size_t capture_length_;
+	size_t marker_;          // offset of the next record
+	float speed_ = 1;        // 0 : as fast as possible
+	uint64_t elapsed_;       // replay time, in microseconds
+	uint64_t record_time_;   // capture time of the next record relative to the first one, in microseconds
+	uint32_t previous_stamp_;
+	unsigned long last_micros_;
+	bool mapped_ = false;
+
+private:
+	/**
+	 * Returns the next packet if it is due, NULL otherwise.
+	 */
+	unsigned char *nextDuePacket(size_t *length);
+
+	bool attach(unsigned char *capture, size_t length);
+
+public:
+	MicroOscReplay();
+
+	// owns the mapping of a file opened with open()
+	MicroOscReplay(const MicroOscReplay &) = delete;
+	MicroOscReplay &operator=(const MicroOscReplay &) = delete;
+
+	/**
+	 * Replays a capture that is already in memory. Closes the file opened with open(), if any.
+	 * Returns false if the buffer does not start with a capture header.
+	 */
+	bool begin(unsigned char *capture, size_t length);
+
+#if defined(__linux__)
+	/**
+	 * Memory-maps a capture file and replays it. Linux only.
+	 * Returns false if the file can not be mapped or is not a capture.
+	 */
+	bool open(const char *path);
+
+	/**
+	 * Unmaps a capture opened with open().
+	 */
+	void close();
+
+	~MicroOscReplay();
+#endif
+
+	/**
+	 * Sets the replay speed: 1 for the original timing, 2 for twice as fast... 0 for as fast as possible.
+	 */
+	void setSpeed(float speed)
+	{
+		speed_ = speed;
+	}
+
+	/**
+	 * Parses every packet that is due with osc.parseMessages(callback).
+	 * Call it in loop(). Returns false once the whole capture was replayed.
+	 */
+	bool update(MicroOsc &osc, MicroOsc::MicroOscCallback callback);
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+	bool update(MicroOsc &osc, MicroOsc::MicroOscCallbackWithSource callback);
+#endif
+
+	/**
+	 * Returns true once the whole capture was replayed.
+	 */
+	bool isFinished()
+	{
+		return marker_ >= capture_length_;
+	}
+};
+
+#endif // MICRO_OSC_NO_CAPTURE
+
+#endif // _MICRO_OSC_CAPTURE_
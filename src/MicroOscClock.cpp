@@ -0,0 +1,120 @@
+#include "MicroOscClock.h"
+
+// the drift is only measured between samples at least this far apart
+#define MICRO_OSC_CLOCK_MIN_DRIFT_INTERVAL 10000000ULL
+
+uint64_t MicroOscClock::timetagToMicros(uint64_t timetag)
+{
+  uint64_t seconds = timetag >> 32;
+  uint64_t fraction = timetag & 0xFFFFFFFFULL;
+  return seconds * 1000000ULL + ((fraction * 1000000ULL + 0x80000000ULL) >> 32);
+}
+
+uint64_t MicroOscClock::microsToTimetag(uint64_t micros)
+{
+  uint64_t seconds = micros / 1000000ULL;
+  uint64_t fraction = (((micros % 1000000ULL) << 32) + 500000ULL) / 1000000ULL;
+  return (seconds << 32) | fraction;
+}
+
+uint64_t MicroOscClock::localMicros()
+{
+  // only the low 32 bits, unsigned long is 64-bit on some hosts
+  uint32_t now = (uint32_t)micros();
+  if (now < micros_last_)
+    micros_high_++;
+  micros_last_ = now;
+  return ((uint64_t)micros_high_ << 32) | now;
+}
+
+uint64_t MicroOscClock::toTimetag(uint64_t local)
+{
+  if (!synchronized_)
+    return microsToTimetag(local);
+  int64_t elapsed = (int64_t)(local - anchor_local_);
+  int64_t offset = anchor_offset_ + (int64_t)(elapsed * drift_);
+  return microsToTimetag(local + offset);
+}
+
+uint64_t MicroOscClock::toLocalMicros(uint64_t timetag)
+{
+  uint64_t host = timetagToMicros(timetag);
+  if (!synchronized_)
+    return host;
+  // first order inverse of toTimetag()
+  int64_t elapsed = (int64_t)(host - anchor_offset_ - anchor_local_);
+  return host - anchor_offset_ - (int64_t)(elapsed * drift_);
+}
+
+uint64_t MicroOscClock::now()
+{
+  return toTimetag(localMicros());
+}
+
+void MicroOscClock::sendPing(MicroOsc &osc)
+{
+  // the raw local time is sent as is and comes back unchanged in the pong
+  osc.sendTimetag("/microosc/clock/ping", microsToTimetag(localMicros()));
+}
+
+bool MicroOscClock::handlePong(MicroOscMessage &msg)
+{
+  if (!msg.checkOscAddressAndTypeTags("/microosc/clock/pong", "ttt"))
+    return false;
+  uint64_t t4 = localMicros();
+  uint64_t t1 = timetagToMicros(msg.nextAsTimetag());
+  uint64_t t2 = msg.nextAsTimetag();
+  uint64_t t3 = msg.nextAsTimetag();
+  addSample(t1, t2, t3, t4);
+  return true;
+}
+
+void MicroOscClock::addSample(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4)
+{
+  int64_t hostReceive = (int64_t)timetagToMicros(t2);
+  int64_t hostSend = (int64_t)timetagToMicros(t3);
+  int64_t roundTrip = ((int64_t)(t4 - t1)) - (hostSend - hostReceive);
+  if (roundTrip < 0)
+    roundTrip = 0;
+
+  Sample &sample = samples_[sample_next_];
+  sample.local = t1 + (t4 - t1) / 2;
+  sample.offset = ((hostReceive - (int64_t)t1) + (hostSend - (int64_t)t4)) / 2;
+  sample.roundTrip = (uint32_t)roundTrip;
+  sample_next_ = (sample_next_ + 1) % MICRO_OSC_CLOCK_SAMPLES;
+  if (sample_count_ < MICRO_OSC_CLOCK_SAMPLES)
+    sample_count_++;
+
+  // clock filter: the shortest round trip has the smallest error
+  const Sample *best = &samples_[0];
+  for (uint8_t i = 1; i < sample_count_; i++)
+  {
+    if (samples_[i].roundTrip < best->roundTrip)
+      best = &samples_[i];
+  }
+
+  if (!synchronized_)
+  {
+    synchronized_ = true;
+    drift_local_ = best->local;
+    drift_offset_ = best->offset;
+  }
+  else
+  {
+    if (best->local <= anchor_local_)
+      return; // already in use
+    uint64_t interval = best->local - drift_local_;
+    if (interval >= MICRO_OSC_CLOCK_MIN_DRIFT_INTERVAL)
+    {
+      float measured = (float)(best->offset - drift_offset_) / (float)interval;
+      // smooth the drift, the first measure is used as is
+      drift_ = drift_measured_ ? drift_ + (measured - drift_) / 4 : measured;
+      drift_measured_ = true;
+      drift_local_ = best->local;
+      drift_offset_ = best->offset;
+    }
+  }
+  anchor_local_ = best->local;
+  anchor_offset_ = best->offset;
+  round_trip_ = best->roundTrip;
+}
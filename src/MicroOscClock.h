@@ -0,0 +1,105 @@
+/* MicroOscClock
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_CLOCK_
+#define _MICRO_OSC_CLOCK_
+
+#include <Arduino.h>
+#include "MicroOsc.h"
+
+#define MICRO_OSC_CLOCK_SAMPLES 8
+
+/**
+ * Maps micros() to OSC (NTP) timetags.
+ * The offset and the drift between the two clocks are estimated from ping exchanges with a host:
+ * - the device sends `/microosc/clock/ping` with its own send time t1 (sendPing())
+ * - the host answers `/microosc/clock/pong` with t1, its receive time t2 and its send time t3 (handlePong())
+ * As with NTP, the sample with the shortest round trip of the last MICRO_OSC_CLOCK_SAMPLES is used.
+ */
+class MicroOscClock
+{
+	struct Sample
+	{
+		uint64_t local;  // local time at the middle of the exchange, in microseconds
+		int64_t offset;  // host time - local time, in microseconds
+		uint32_t roundTrip;
+	};
+
+	Sample samples_[MICRO_OSC_CLOCK_SAMPLES];
+	uint8_t sample_count_ = 0;
+	uint8_t sample_next_ = 0;
+
+	bool synchronized_ = false;
+	uint64_t anchor_local_;  // local time of the sample the model is based on
+	int64_t anchor_offset_;
+	uint64_t drift_local_;   // sample the drift is measured from
+	int64_t drift_offset_;
+	float drift_ = 0;        // (host rate / local rate) - 1
+	bool drift_measured_ = false;
+	uint32_t round_trip_ = 0;
+
+	uint32_t micros_high_ = 0;
+	uint32_t micros_last_ = 0;
+
+public:
+	/**
+	 * Returns micros() extended to 64 bits. Must be called at least once every 71 minutes to detect the wrap around.
+	 */
+	uint64_t localMicros();
+
+	/**
+	 * Returns the current time as a timetag. Before the first pong, the timetag counts from the start of the board.
+	 */
+	uint64_t now();
+
+	/**
+	 * Converts a localMicros() time to a timetag, and back.
+	 */
+	uint64_t toTimetag(uint64_t localMicros);
+	uint64_t toLocalMicros(uint64_t timetag);
+
+	/**
+	 * Sends a `/microosc/clock/ping` message with the local time.
+	 */
+	void sendPing(MicroOsc &osc);
+
+	/**
+	 * If msg is a `/microosc/clock/pong`, adds it to the estimator and returns true. Returns false otherwise.
+	 */
+	bool handlePong(MicroOscMessage &msg);
+
+	/**
+	 * Adds a ping exchange: t1 and t4 are the local send and receive times (localMicros()), t2 and t3 the host receive and send timetags.
+	 */
+	void addSample(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4);
+
+	bool isSynchronized()
+	{
+		return synchronized_;
+	}
+
+	/**
+	 * Returns the round trip time of the sample in use, in microseconds.
+	 */
+	uint32_t getRoundTrip()
+	{
+		return round_trip_;
+	}
+
+	/**
+	 * Returns the estimated drift of the local clock, in parts per million.
+	 */
+	float getDriftPpm()
+	{
+		return drift_ * 1e6f;
+	}
+
+	/**
+	 * Converts a timetag to microseconds since 1900, and back.
+	 */
+	static uint64_t timetagToMicros(uint64_t timetag);
+	static uint64_t microsToTimetag(uint64_t micros);
+};
+
+#endif // _MICRO_OSC_CLOCK_
@@ -0,0 +1,98 @@
+#include "MicroOscCoalescer.h"
+#include "MicroOscUtility.h"
+
+MicroOscCoalescer::MicroOscCoalescer(MicroOscCoalescedEntry *entries, size_t slots, void *bytes, size_t size)
+{
+  entries_ = entries;
+  slots_ = slots;
+  bytes_ = (unsigned char *)bytes;
+  // offsets are 16-bit
+  size_ = (size > 0xFFFF) ? 0xFFFF : size;
+}
+
+uint16_t MicroOscCoalescer::hashKey(MicroOscMessage &msg)
+{
+  // 0 is reserved for events
+  uint32_t h = microOscHash(msg.getOscAddress());
+  if (by_type_tags_)
+    h = microOscHash(msg.getTypeTags(), h);
+  uint16_t hash = microOscFoldHash(h);
+  return (hash == 0) ? 1 : hash;
+}
+
+bool MicroOscCoalescer::isEvent(const char *address)
+{
+  for (size_t i = 0; i < event_count_; i++)
+  {
+    if (strcmp(events_[i], address) == 0)
+      return true;
+  }
+  return false;
+}
+
+bool MicroOscCoalescer::sameKey(const MicroOscCoalescedEntry &entry, MicroOscMessage &msg)
+{
+  const char *address = (const char *)(bytes_ + entry.offset);
+  if (strcmp(address, msg.getOscAddress()) != 0)
+    return false;
+  if (!by_type_tags_)
+    return true;
+  // the type tags follow the address padded to 4 bytes, after the ','
+  const char *typeTags = address + ((strlen(address) + 4) & ~(size_t)3) + 1;
+  return strcmp(typeTags, msg.getTypeTags()) == 0;
+}
+
+bool MicroOscCoalescer::append(MicroOscCoalescedEntry &entry, const unsigned char *data, size_t length)
+{
+  if (length > size_ - used_)
+    return false;
+  memcpy(bytes_ + used_, data, length);
+  entry.offset = used_;
+  entry.length = length;
+  entry.capacity = length;
+  used_ += (length + 3) & ~(size_t)3;
+  if (used_ > size_)
+    used_ = size_;
+  return true;
+}
+
+bool MicroOscCoalescer::store(MicroOscMessage &msg, uint64_t timetag)
+{
+  const unsigned char *data = msg.getRawMessage();
+  size_t length = msg.getRawMessageLength();
+
+  uint16_t hash = isEvent(msg.getOscAddress()) ? 0 : hashKey(msg);
+
+  if (hash != 0)
+  {
+    for (size_t i = 0; i < count_; i++)
+    {
+      MicroOscCoalescedEntry &entry = entries_[i];
+      if (entry.hash != hash || !sameKey(entry, msg))
+        continue;
+      // replace the stale message, in place if it fits
+      if (length <= entry.capacity)
+      {
+        memcpy(bytes_ + entry.offset, data, length);
+        entry.length = length;
+      }
+      else if (!append(entry, data, length))
+      {
+        return false;
+      }
+      entry.timetag = timetag;
+      coalesced_++;
+      return true;
+    }
+  }
+
+  if (count_ >= slots_)
+    return false;
+  MicroOscCoalescedEntry &entry = entries_[count_];
+  if (!append(entry, data, length))
+    return false;
+  entry.hash = hash;
+  entry.timetag = timetag;
+  count_++;
+  return true;
+}
@@ -0,0 +1,135 @@
+/* MicroOscCoalescer
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_COALESCER_
+#define _MICRO_OSC_COALESCER_
+
+#include <Arduino.h>
+#include "MicroOscMessage.h"
+
+/**
+ * A message kept by a MicroOscCoalescer.
+ */
+struct MicroOscCoalescedEntry
+{
+	uint16_t offset;   // of the message in the bytes of the coalescer
+	uint16_t length;   // of the message
+	uint16_t capacity; // bytes reserved for the message, it can be replaced in place by a message as long
+	uint16_t hash;     // hash of the key, 0 for an event that is never replaced
+	uint64_t timetag;  // of the bundle the message came from, 0 if it was not in a bundle
+};
+
+/**
+ * Receive stage that keeps only the newest message per address (or per address and type tags)
+ * of all the packets received by one call of onOscMessageReceived(). The surviving messages are then
+ * dispatched in the order their address was first received.
+ * Messages of event addresses (see setEventAddresses()) are all kept.
+ * When the table is full, the messages kept so far are dispatched to make room.
+ * Use MicroOscMessageCoalescer<SLOTS, BYTES> to reserve the memory and MicroOsc::setCoalescer() to enable it.
+ */
+class MicroOscCoalescer
+{
+	MicroOscCoalescedEntry *entries_;
+	size_t slots_;
+	unsigned char *bytes_;
+	size_t size_;
+	size_t count_ = 0;
+	size_t used_ = 0;
+	bool by_type_tags_ = false;
+	const char *const *events_ = NULL;
+	size_t event_count_ = 0;
+	uint32_t coalesced_ = 0;
+
+private:
+	uint16_t hashKey(MicroOscMessage &msg);
+	bool isEvent(const char *address);
+	bool sameKey(const MicroOscCoalescedEntry &entry, MicroOscMessage &msg);
+	bool append(MicroOscCoalescedEntry &entry, const unsigned char *data, size_t length);
+
+public:
+	/**
+	 * bytes must be aligned on 4 bytes.
+	 */
+	MicroOscCoalescer(MicroOscCoalescedEntry *entries, size_t slots, void *bytes, size_t size);
+
+	/**
+	 * When true, messages with the same address but other type tags are kept separately.
+	 */
+	void setCoalesceByTypeTags(bool byTypeTags)
+	{
+		by_type_tags_ = byTypeTags;
+	}
+
+	/**
+	 * Addresses whose messages are never coalesced (notes, triggers...). The array is not copied.
+	 */
+	void setEventAddresses(const char *const *addresses, size_t count)
+	{
+		events_ = addresses;
+		event_count_ = count;
+	}
+
+	/**
+	 * Keeps a copy of msg and the timetag of its bundle, replacing the previous message with the same key.
+	 * Returns false if there is no room left.
+	 */
+	bool store(MicroOscMessage &msg, uint64_t timetag = 0);
+
+	/**
+	 * Number of messages kept.
+	 */
+	size_t count()
+	{
+		return count_;
+	}
+
+	/**
+	 * Returns the raw bytes of the kept message index.
+	 */
+	unsigned char *getMessage(size_t index, size_t *length)
+	{
+		*length = entries_[index].length;
+		return bytes_ + entries_[index].offset;
+	}
+
+	/**
+	 * Returns the timetag of the bundle of the kept message index, 0 if it was not in a bundle.
+	 */
+	uint64_t getTimetag(size_t index)
+	{
+		return entries_[index].timetag;
+	}
+
+	/**
+	 * Forgets every kept message.
+	 */
+	void clear()
+	{
+		count_ = 0;
+		used_ = 0;
+	}
+
+	/**
+	 * Returns the number of stale messages that were replaced by a newer one, and were never dispatched.
+	 */
+	uint32_t getCoalescedCount()
+	{
+		return coalesced_;
+	}
+};
+
+template <const size_t SLOTS, const size_t BYTES>
+class MicroOscMessageCoalescer : public MicroOscCoalescer
+{
+protected:
+	MicroOscCoalescedEntry entries_[SLOTS];
+	uint32_t bytes_[(BYTES + 3) / 4];
+
+public:
+	MicroOscMessageCoalescer() : MicroOscCoalescer(entries_, SLOTS, bytes_, sizeof(bytes_))
+	{
+	}
+};
+
+#endif // _MICRO_OSC_COALESCER_
@@ -0,0 +1,51 @@
+/* MicroOscConfig
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_CONFIG_
+#define _MICRO_OSC_CONFIG_
+
+/*
+ * Compile-time feature selection, to save flash and RAM on small boards (ATmega328...).
+ *
+ * The Arduino IDE compiles the library without the #defines of the sketch, so either
+ * uncomment the lines below or give the macros as compiler flags:
+ *   arduino-cli compile --build-property "compiler.cpp.extra_flags=-DMICRO_OSC_NO_DOUBLE" ...
+ *   PlatformIO: build_flags = -DMICRO_OSC_NO_DOUBLE
+ * extras/size_report measures the flash and RAM used by each configuration.
+ *
+ * The readers of MicroOscMessage (nextAsDouble()...) are removed by the linker when they are not used
+ * and received arguments of a removed type are still skipped, so these macros only remove
+ * the code that would otherwise stay in the program.
+ */
+
+// Removes messageAddDouble(), sendDouble() and 'd' from sendMessage()
+// #define MICRO_OSC_NO_DOUBLE
+
+// Removes messageAddInt64(), sendInt64() and 'h' from sendMessage(). Timetags ('t') are kept.
+// #define MICRO_OSC_NO_INT64
+
+// Removes messageAddBlob(), sendBlob() and 'b' from sendMessage()
+// #define MICRO_OSC_NO_BLOB
+
+// Removes messageAddMidi(), sendMidi() and 'm' from sendMessage()
+// #define MICRO_OSC_NO_MIDI
+
+// Removes bundles: received bundles are ignored, and setBundleBuffer(), setAutoBatch(),
+// bundleBegin(), bundleEnd() and flush() are removed
+// #define MICRO_OSC_NO_BUNDLES
+
+// Removes the callbacks that receive the source MicroOsc (MicroOscCallbackWithSource),
+// so the transports keep a single onOscMessageReceived(). Also removes MicroOscHub.
+// #define MICRO_OSC_NO_SOURCE_CALLBACK
+
+// Removes the transmit queue: setTransmitQueue(), setTransmitPriority() and the pacing of MicroOscUdp
+// #define MICRO_OSC_NO_QUEUE
+
+// Removes setCoalescer(), received messages are always handled one by one
+// #define MICRO_OSC_NO_COALESCER
+
+// Removes setCapture(), MicroOscCapture and MicroOscReplay
+// #define MICRO_OSC_NO_CAPTURE
+
+#endif // _MICRO_OSC_CONFIG_
@@ -0,0 +1,154 @@
+#include "MicroOscDispatch.h"
+
+#if defined(__linux__) || defined(ESP_PLATFORM)
+
+#include "MicroOscUtility.h"
+
+MicroOscShardedDispatch *MicroOscShardedDispatch::current_ = NULL;
+
+#if defined(__linux__)
+MicroOscShardedDispatch::MicroOscShardedDispatch(MicroOscShard *shards, size_t count, unsigned char *slots, uint32_t slotSize, uint32_t slotCount, std::thread *threads)
+    : threads_(threads), running_(false)
+#else
+MicroOscShardedDispatch::MicroOscShardedDispatch(MicroOscShard *shards, size_t count, unsigned char *slots, uint32_t slotSize, uint32_t slotCount)
+#endif
+{
+  shards_ = shards;
+  count_ = count;
+  slots_ = slots;
+  slot_size_ = slotSize;
+  // slot() masks the index: only a power of two of the slots is used
+  while ((slotCount & (slotCount - 1)) != 0)
+    slotCount &= slotCount - 1;
+  slot_count_ = slotCount;
+  for (size_t i = 0; i < count_; i++)
+  {
+    shards_[i].head.store(0, std::memory_order_relaxed);
+    shards_[i].tail.store(0, std::memory_order_relaxed);
+    shards_[i].waiting.store(0, std::memory_order_relaxed);
+    shards_[i].highWater.store(0, std::memory_order_relaxed);
+    shards_[i].dropped.store(0, std::memory_order_relaxed);
+    shards_[i].handled.store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t MicroOscShardedDispatch::getWorker(const char *address)
+{
+  return microOscHash(address) % count_;
+}
+
+bool MicroOscShardedDispatch::post(MicroOscMessage &msg)
+{
+  MicroOscShard &shard = shards_[getWorker(msg.getOscAddress())];
+  size_t length = msg.getRawMessageLength();
+  uint32_t head = shard.head.load(std::memory_order_relaxed);
+  uint32_t used = head - shard.tail.load(std::memory_order_acquire);
+  if (used >= slot_count_ || length > slot_size_ - 4)
+  {
+    shard.dropped.store(shard.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return false;
+  }
+
+  unsigned char *destination = slot(&shard - shards_, head);
+  uint32_t length32 = length;
+  memcpy(destination, &length32, 4);
+  memcpy(destination + 4, msg.getRawMessage(), length);
+  shard.head.store(head + 1, std::memory_order_seq_cst);
+
+  if (used + 1 > shard.highWater.load(std::memory_order_relaxed))
+    shard.highWater.store(used + 1, std::memory_order_relaxed);
+
+#if defined(__linux__)
+  if (shard.waiting.load(std::memory_order_seq_cst))
+    microOscFutexWake(&shard.head);
+#endif
+  return true;
+}
+
+void MicroOscShardedDispatch::onMessage(MicroOscMessage &msg)
+{
+  current_->post(msg);
+}
+
+void MicroOscShardedDispatch::update(MicroOsc &osc)
+{
+  MicroOscShardedDispatch *updating = current_;
+  current_ = this;
+  osc.onOscMessageReceived(onMessage);
+  current_ = updating;
+}
+
+size_t MicroOscShardedDispatch::work(size_t worker, size_t max)
+{
+  MicroOscShard &shard = shards_[worker];
+  uint32_t tail = shard.tail.load(std::memory_order_relaxed);
+  uint32_t head = shard.head.load(std::memory_order_acquire);
+  size_t handled = 0;
+  while (tail != head && handled < max)
+  {
+    unsigned char *source = slot(worker, tail);
+    uint32_t length;
+    memcpy(&length, source, 4);
+    MicroOscMessage msg;
+    if (handler_ != NULL && msg.parseMessage(source + 4, length) == 0)
+      handler_(msg);
+    // the slot is given back to post() after the handler
+    shard.tail.store(++tail, std::memory_order_release);
+    handled++;
+  }
+  if (handled > 0)
+    shard.handled.store(shard.handled.load(std::memory_order_relaxed) + handled, std::memory_order_relaxed);
+  return handled;
+}
+
+void MicroOscShardedDispatch::resetHighWaterMarks()
+{
+  for (size_t i = 0; i < count_; i++)
+    shards_[i].highWater.store(0, std::memory_order_relaxed);
+}
+
+#if defined(__linux__)
+
+bool MicroOscShardedDispatch::wait(size_t worker, uint32_t timeoutMicros)
+{
+  MicroOscShard &shard = shards_[worker];
+  uint32_t head = shard.head.load(std::memory_order_acquire);
+  if (head != shard.tail.load(std::memory_order_relaxed))
+    return true;
+
+  microOscFutexWait(&shard.head, &shard.waiting, head, timeoutMicros);
+  return getQueuedCount(worker) > 0;
+}
+
+void MicroOscShardedDispatch::start()
+{
+  if (running_.exchange(true))
+    return;
+  for (size_t i = 0; i < count_; i++)
+  {
+    threads_[i] = std::thread([this, i]() {
+      while (running_.load(std::memory_order_relaxed))
+      {
+        if (work(i, slot_count_) == 0)
+          wait(i, 10000);
+      }
+      work(i);
+    });
+  }
+}
+
+void MicroOscShardedDispatch::stop()
+{
+  if (!running_.exchange(false))
+    return;
+  for (size_t i = 0; i < count_; i++)
+  {
+    microOscFutexWake(&shards_[i].head);
+    if (threads_[i].joinable())
+      threads_[i].join();
+  }
+}
+
+#endif // __linux__
+
+#endif // __linux__ || ESP_PLATFORM
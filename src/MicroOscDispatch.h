@@ -0,0 +1,190 @@
+/* MicroOscDispatch
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_DISPATCH_
+#define _MICRO_OSC_DISPATCH_
+
+#include <MicroOsc.h>
+
+// Needs std::atomic and more than one core or thread: Linux hosts and ESP32
+#if defined(__linux__) || defined(ESP_PLATFORM)
+
+#include <atomic>
+#if defined(__linux__)
+#include <thread>
+#endif
+
+/**
+ * The queue of one worker: a single producer, single consumer ring of fixed size slots.
+ * head is only written by the receiving thread and tail by the worker.
+ */
+struct MicroOscShard
+{
+	std::atomic<uint32_t> head;
+	uint8_t pad0_[60];
+	std::atomic<uint32_t> tail;
+	uint8_t pad1_[60];
+	std::atomic<uint32_t> waiting;	  // set by a worker sleeping on head (Linux)
+	std::atomic<uint32_t> highWater; // most slots used at once
+	std::atomic<uint32_t> dropped;	  // messages that did not fit
+	std::atomic<uint32_t> handled;	  // messages given to the handler
+	uint8_t pad2_[48];
+};
+
+/**
+ * Runs the handler of the received messages on worker threads or cores instead of the receiving thread,
+ * so a slow handler does not hold up the other messages.
+ * Each message is copied into the queue of the worker chosen by the hash of its address: the messages
+ * with the same address are always handled by the same worker, in the order they were received.
+ * post() (or update()) must always be called from the same thread, and work(worker) from one thread per worker.
+ * Linux only: start() runs one thread per worker. Use MicroOscWorkerQueues<WORKERS, SLOT_SIZE, SLOT_COUNT> to reserve the memory.
+ * The slot count must be a power of two, so the 32-bit head and tail can wrap: the constructor rounds
+ * it down to a power of two and MicroOscWorkerQueues checks it at compile time.
+ */
+class MicroOscShardedDispatch
+{
+	MicroOscShard *shards_;
+	size_t count_;
+	unsigned char *slots_;
+	uint32_t slot_size_;
+	uint32_t slot_count_;
+	MicroOsc::MicroOscCallback handler_ = NULL;
+
+	static MicroOscShardedDispatch *current_; // the dispatch being updated
+
+#if defined(__linux__)
+	std::thread *threads_;
+	std::atomic<bool> running_;
+#endif
+
+private:
+	unsigned char *slot(size_t worker, uint32_t index)
+	{
+		return slots_ + ((size_t)worker * slot_count_ + (index & (slot_count_ - 1))) * slot_size_;
+	}
+	static void onMessage(MicroOscMessage &msg);
+
+public:
+#if defined(__linux__)
+	MicroOscShardedDispatch(MicroOscShard *shards, size_t count, unsigned char *slots, uint32_t slotSize, uint32_t slotCount, std::thread *threads);
+#else
+	MicroOscShardedDispatch(MicroOscShard *shards, size_t count, unsigned char *slots, uint32_t slotSize, uint32_t slotCount);
+#endif
+
+	/**
+	 * Sets the function called by the workers. It runs on the thread of the worker.
+	 */
+	void setHandler(MicroOsc::MicroOscCallback handler)
+	{
+		handler_ = handler;
+	}
+
+	size_t getWorkerCount()
+	{
+		return count_;
+	}
+
+	/**
+	 * Returns the worker that handles the messages with this address.
+	 */
+	size_t getWorker(const char *address);
+
+	/**
+	 * Copies the message into the queue of its worker.
+	 * Returns false, and counts the message as dropped, if the queue is full or the message is larger than a slot.
+	 */
+	bool post(MicroOscMessage &msg);
+
+	/**
+	 * Receives the messages of osc and posts them. Call it in the loop of the receiving thread.
+	 */
+	void update(MicroOsc &osc);
+
+	/**
+	 * Gives at most max queued messages of worker to the handler. Call it in the loop of the thread (or the task
+	 * pinned to a core) of the worker. Returns the number of messages handled.
+	 */
+	size_t work(size_t worker, size_t max = SIZE_MAX);
+
+#if defined(__linux__)
+	/**
+	 * Starts one thread per worker. Linux only.
+	 */
+	void start();
+
+	/**
+	 * Stops the threads, the messages still queued are handled first.
+	 */
+	void stop();
+
+	/**
+	 * Sleeps until a message is queued for worker or timeoutMicros is over. Returns true if a message is queued.
+	 */
+	bool wait(size_t worker, uint32_t timeoutMicros);
+#endif
+
+	// METRICS
+	/**
+	 * Returns the number of messages waiting in the queue of worker.
+	 */
+	uint32_t getQueuedCount(size_t worker)
+	{
+		return shards_[worker].head.load(std::memory_order_acquire) - shards_[worker].tail.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Returns the most messages that waited at once in the queue of worker, to size the queues.
+	 */
+	uint32_t getHighWaterMark(size_t worker)
+	{
+		return shards_[worker].highWater.load(std::memory_order_relaxed);
+	}
+
+	uint32_t getDroppedCount(size_t worker)
+	{
+		return shards_[worker].dropped.load(std::memory_order_relaxed);
+	}
+
+	uint32_t getHandledCount(size_t worker)
+	{
+		return shards_[worker].handled.load(std::memory_order_relaxed);
+	}
+
+	void resetHighWaterMarks();
+};
+
+template <const size_t WORKERS, const size_t SLOT_SIZE = 256, const size_t SLOT_COUNT = 32>
+class MicroOscWorkerQueues : public MicroOscShardedDispatch
+{
+	static const size_t ALIGNED_SIZE = (SLOT_SIZE + 3) & ~(size_t)3;
+	static_assert(SLOT_COUNT > 0 && (SLOT_COUNT & (SLOT_COUNT - 1)) == 0, "SLOT_COUNT must be a power of two");
+
+protected:
+	MicroOscShard shards_[WORKERS];
+	alignas(4) unsigned char slots_[WORKERS * SLOT_COUNT * ALIGNED_SIZE];
+#if defined(__linux__)
+	std::thread threads_[WORKERS];
+#endif
+
+public:
+#if defined(__linux__)
+	MicroOscWorkerQueues() : MicroOscShardedDispatch(shards_, WORKERS, slots_, ALIGNED_SIZE, SLOT_COUNT, threads_)
+	{
+	}
+
+	// the threads must be joined before they are destroyed
+	~MicroOscWorkerQueues()
+	{
+		stop();
+	}
+#else
+	MicroOscWorkerQueues() : MicroOscShardedDispatch(shards_, WORKERS, slots_, ALIGNED_SIZE, SLOT_COUNT)
+	{
+	}
+#endif
+};
+
+#endif // __linux__ || ESP_PLATFORM
+
+#endif // _MICRO_OSC_DISPATCH_
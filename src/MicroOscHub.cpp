@@ -0,0 +1,135 @@
+#include "MicroOscHub.h"
+
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+MicroOscHub::MicroOscHub(MicroOscHubSource *sources, size_t capacity)
+{
+  sources_ = sources;
+  capacity_ = capacity;
+}
+
+int MicroOscHub::add(MicroOsc &osc, uint8_t budget, int fileDescriptor)
+{
+  if (count_ >= capacity_)
+    return -1;
+  MicroOscHubSource &source = sources_[count_];
+  source.osc = &osc;
+  source.fileDescriptor = fileDescriptor;
+  source.pending = false;
+  osc.setReceiveBudget(budget);
+
+#if defined(__linux__)
+  if (fileDescriptor >= 0)
+  {
+    if (epoll_ < 0)
+      epoll_ = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = count_;
+    if (epoll_ < 0 || epoll_ctl(epoll_, EPOLL_CTL_ADD, fileDescriptor, &event) != 0)
+      source.fileDescriptor = -1; // polled instead
+  }
+#endif
+
+  return (int)count_++;
+}
+
+int MicroOscHub::getSourceId(const MicroOsc &osc)
+{
+  for (size_t i = 0; i < count_; i++)
+  {
+    if (sources_[i].osc == &osc)
+      return (int)i;
+  }
+  return -1;
+}
+
+void MicroOscHub::serve(MicroOscHubSource &source)
+{
+  uint32_t before = source.osc->getReceivedPacketCount();
+  source.osc->onOscMessageReceived(handler_);
+  uint32_t handled = source.osc->getReceivedPacketCount() - before;
+  uint8_t budget = source.osc->getReceiveBudget();
+  source.pending = (budget > 0 && handled >= budget);
+}
+
+void MicroOscHub::update()
+{
+  if (count_ == 0 || handler_ == NULL)
+    return;
+  for (size_t n = 0; n < count_; n++)
+  {
+    size_t i = cursor_ + n;
+    if (i >= count_)
+      i -= count_;
+    serve(sources_[i]);
+  }
+  cursor_ = (cursor_ + 1 < count_) ? cursor_ + 1 : 0;
+}
+
+#if defined(__linux__)
+
+MicroOscHub::~MicroOscHub()
+{
+  if (epoll_ >= 0)
+    close(epoll_);
+}
+
+int MicroOscHub::wait(int timeoutMillis)
+{
+  if (count_ == 0 || handler_ == NULL)
+    return 0;
+
+  // do not sleep while a source has packets left or can only be polled
+  for (size_t i = 0; i < count_; i++)
+  {
+    if (sources_[i].pending)
+      timeoutMillis = 0;
+    else if (sources_[i].fileDescriptor < 0 && timeoutMillis > 1)
+      timeoutMillis = 1;
+  }
+
+  const int maxEvents = 16;
+  struct epoll_event events[maxEvents];
+  int ready = 0;
+  if (epoll_ >= 0)
+  {
+    ready = epoll_wait(epoll_, events, maxEvents, timeoutMillis);
+    if (ready < 0)
+      ready = 0;
+  }
+  else if (timeoutMillis > 0)
+  {
+    usleep(timeoutMillis * 1000);
+  }
+
+  for (int e = 0; e < ready; e++)
+  {
+    uint32_t i = events[e].data.u32;
+    if (i < count_)
+      sources_[i].pending = true;
+  }
+
+  // serve in turn, starting with the next source at every call
+  for (size_t n = 0; n < count_; n++)
+  {
+    size_t i = cursor_ + n;
+    if (i >= count_)
+      i -= count_;
+    MicroOscHubSource &source = sources_[i];
+    if (source.pending || source.fileDescriptor < 0)
+      serve(source);
+  }
+  cursor_ = (cursor_ + 1 < count_) ? cursor_ + 1 : 0;
+  return ready;
+}
+
+#endif
+
+#endif // MICRO_OSC_NO_SOURCE_CALLBACK
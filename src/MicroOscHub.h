@@ -0,0 +1,107 @@
+/* MicroOscHub
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_HUB_
+#define _MICRO_OSC_HUB_
+
+#include <Arduino.h>
+#include "MicroOsc.h"
+
+// the hub gives the source of each message to its handler
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+
+/**
+ * A MicroOsc instance registered in a MicroOscHub.
+ */
+struct MicroOscHubSource
+{
+	MicroOsc *osc;
+	int fileDescriptor; // -1 if the transport can not be waited on
+	bool pending;		// the budget was used up, there may be more packets
+};
+
+/**
+ * Serves many MicroOsc instances (SLIP, UDP...) from one loop with one handler.
+ * The handler receives the MicroOsc a message comes from, getSourceId() identifies it.
+ * update() polls every source in turn, starting with the next one at every call, and each source
+ * handles at most its budget of packets per turn so a busy link can not starve the others.
+ * On Linux, wait() blocks with epoll until one of the file descriptors of the sources is readable.
+ * Use MicroOscTransportHub<CAPACITY> to reserve the memory.
+ */
+class MicroOscHub
+{
+	MicroOscHubSource *sources_;
+	size_t capacity_;
+	size_t count_ = 0;
+	size_t cursor_ = 0; // source served first by the next turn
+	MicroOsc::MicroOscCallbackWithSource handler_ = NULL;
+#if defined(__linux__)
+	int epoll_ = -1;
+#endif
+
+private:
+	void serve(MicroOscHubSource &source);
+
+public:
+	MicroOscHub(MicroOscHubSource *sources, size_t capacity);
+#if defined(__linux__)
+	~MicroOscHub();
+#endif
+
+	/**
+	 * Sets the function called for the messages of every source.
+	 */
+	void setHandler(MicroOsc::MicroOscCallbackWithSource handler)
+	{
+		handler_ = handler;
+	}
+
+	/**
+	 * Registers a source that handles at most budget packets per turn (see MicroOsc::setReceiveBudget()).
+	 * fileDescriptor is only used by wait() (Linux), -1 if the transport has none.
+	 * Returns the id of the source, -1 if the hub is full.
+	 */
+	int add(MicroOsc &osc, uint8_t budget = 4, int fileDescriptor = -1);
+
+	/**
+	 * Returns the id of a registered source, -1 if it is not registered.
+	 */
+	int getSourceId(const MicroOsc &osc);
+
+	/**
+	 * Gives one turn to every source. Call it in loop().
+	 */
+	void update();
+
+#if defined(__linux__)
+	/**
+	 * Blocks until a file descriptor of a source is readable or timeoutMillis is over, then gives a turn
+	 * to the sources that are readable, that used up their budget at their last turn or that have no file descriptor.
+	 * Sources without a file descriptor are polled at least every millisecond. Linux only.
+	 * Returns the number of sources that were readable.
+	 */
+	int wait(int timeoutMillis);
+#endif
+
+	size_t count()
+	{
+		return count_;
+	}
+};
+
+template <const size_t CAPACITY>
+class MicroOscTransportHub : public MicroOscHub
+{
+protected:
+	MicroOscHubSource sources_[CAPACITY];
+
+public:
+	MicroOscTransportHub() : MicroOscHub(sources_, CAPACITY)
+	{
+	}
+};
+
+#endif // MICRO_OSC_NO_SOURCE_CALLBACK
+
+#endif // _MICRO_OSC_HUB_
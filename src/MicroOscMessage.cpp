@@ -5,67 +5,109 @@ MicroOscMessage::MicroOscMessage()
 {
 }
 
-int32_t MicroOscMessage::nextAsInt()
-{
-  // convert from big-endian (network btye order)
-  const int32_t iBE = *((int32_t *)marker_);
-  const int32_t i = swapBigEndian32(iBE);
-  // marker += 4;
-  advance(4);
-  return i;
-}
-
+template <class Policy>
 int MicroOscMessage::parseMessage(unsigned char *buffer, const size_t bufferLength)
 {
+  buffer_ = buffer;
+  buffer_length_ = bufferLength;
+  error_ = 0;
+
   // NOTE(mhroth): if there's a comma in the address, that's weird
   size_t i = 0;
-  while (buffer[i] != '\0')
-    ++i; // find the null-terimated address
-  while (buffer[i] != ',')
-    ++i; // find the comma which starts the format string
-  if (i >= bufferLength)
-    return -1; // error while looking for format string
-  // format string is null terminated
-  format_ = (char *)(buffer + i + 1); // format starts after comma
+  if (Policy::checked)
+  {
+    const unsigned char *end = (const unsigned char *)memchr(buffer, '\0', bufferLength);
+    if (end == NULL)
+      return (error_ = MICRO_OSC_ERROR_NO_TYPE_TAGS); // address not null terminated
+    i = end - buffer;
+    while (i < bufferLength && buffer[i] != ',')
+      ++i; // find the comma which starts the format string
+    if (i >= bufferLength)
+      return (error_ = MICRO_OSC_ERROR_NO_TYPE_TAGS); // error while looking for format string
+    format_ = (char *)(buffer + i + 1); // format starts after comma
+    end = (const unsigned char *)memchr(buffer + i, '\0', bufferLength - i);
+    if (end == NULL)
+      return (error_ = MICRO_OSC_ERROR_TYPE_TAGS_NOT_TERMINATED); // format string not null terminated
+    i = end - buffer;
+  }
+  else
+  {
+    while (buffer[i] != '\0')
+      ++i; // find the null-terimated address
+    while (buffer[i] != ',')
+      ++i; // find the comma which starts the format string
+    format_ = (char *)(buffer + i + 1); // format starts after comma
+    while (buffer[i] != '\0')
+      ++i;
+  }
   format_marker_ = format_;
-
-  while (i < bufferLength && buffer[i] != '\0')
-    ++i;
-  if (i == bufferLength)
-    return -2; // format string not null terminated
+  type_marker_ = format_;
 
   i = (i + 4) & ~0x3; // advance to the next multiple of 4 after trailing '\0'
   marker_ = buffer + i;
 
-  buffer_ = buffer;
-  buffer_length_ = bufferLength;
-
+  return 0;
+}
 
+template <class Policy>
+bool MicroOscMessage::check(char typeTag, size_t bytes)
+{
+  // true, false, nil and impulse have no data, the readers of both policies step over them
+  while (*type_marker_ == 'T' || *type_marker_ == 'F' || *type_marker_ == 'N' || *type_marker_ == 'I')
+    type_marker_++;
+  if (!Policy::checked)
+    return true;
+  if (error_ != 0)
+    return false;
+  if (*type_marker_ != typeTag)
+  {
+    error_ = MICRO_OSC_ERROR_TYPE;
+    return false;
+  }
+  if (marker_ + bytes > buffer_ + buffer_length_)
+  {
+    error_ = MICRO_OSC_ERROR_BOUNDS;
+    return false;
+  }
+  return true;
+}
 
-  return 0;
+template <class Policy>
+int32_t MicroOscMessage::nextAsInt()
+{
+  if (!check<Policy>('i', 4))
+    return 0;
+  // convert from big-endian (network btye order)
+  int32_t iBE;
+  memcpy(&iBE, marker_, 4);
+  advance(4);
+  return swapBigEndian32(iBE);
 }
 
+template <class Policy>
 float MicroOscMessage::nextAsFloat()
 {
+  if (!check<Policy>('f', 4))
+    return 0;
   // convert from big-endian (network btye order)
-  const uint32_t iBE = *((uint32_t *)marker_);
-  // marker += 4;
+  uint32_t iBE;
+  memcpy(&iBE, marker_, 4);
   advance(4);
-  /*
-    const uint32_t i  = uOsc_bigEndian(iBE);
-    return *((float *) (&i)); // HARD CAST TO FLOAT
-    */
+
   union IntFloatUnion u;
   u.int_value_ = swapBigEndian32(iBE);
 
   return u.float_value_;
 }
 
+template <class Policy>
 double MicroOscMessage::nextAsDouble()
 {
+  if (!check<Policy>('d', 8))
+    return 0;
   // convert from big-endian (network byte order)
-  const uint64_t iBE = *((uint64_t *)marker_);
-  // marker += 8;
+  uint64_t iBE;
+  memcpy(&iBE, marker_, 8);
   advance(8);
 
   union IntDoubleUnion u;
@@ -74,18 +116,203 @@ double MicroOscMessage::nextAsDouble()
   return u.double_value_;
 }
 
+template <class Policy>
+uint64_t MicroOscMessage::nextAsTimetag()
+{
+  if (!check<Policy>('t', 8))
+    return 0;
+  // convert from big-endian (network byte order)
+  uint64_t tBE;
+  memcpy(&tBE, marker_, 8);
+  advance(8);
+  return swapBigEndian64(tBE);
+}
+
+template <class Policy>
 const char *MicroOscMessage::nextAsString()
 {
-  int i = (int)strlen((const char *)marker_);
-  if (marker_ + i >= buffer_ + buffer_length_)
+  if (!check<Policy>('s', 0))
     return NULL;
   const char *s = (const char *)marker_;
+  size_t i;
+  if (Policy::checked)
+  {
+    const unsigned char *end = (const unsigned char *)memchr(marker_, '\0', buffer_ + buffer_length_ - marker_);
+    if (end == NULL)
+    {
+      error_ = MICRO_OSC_ERROR_BOUNDS;
+      return NULL;
+    }
+    i = end - marker_;
+  }
+  else
+  {
+    i = strlen(s);
+  }
   i = (i + 4) & ~0x3; // advance to next multiple of 4 after trailing '\0'
-  // marker_ += i;
   advance(i);
   return s;
 }
 
+template <class Policy>
+uint32_t MicroOscMessage::nextAsBlob(const unsigned char **blob)
+{
+  *blob = NULL;
+  if (!check<Policy>('b', 4))
+    return 0;
+
+  uint32_t iBE;
+  memcpy(&iBE, marker_, 4);
+  uint32_t length = swapBigEndian32(iBE);
+
+  if (Policy::checked && length > (size_t)(buffer_ + buffer_length_ - marker_ - 4))
+  {
+    // bigger than stored data
+    error_ = MICRO_OSC_ERROR_BOUNDS;
+    return 0;
+  }
+
+  *blob = marker_ + 4;
+  advance((length + 7) & ~0x3);
+  return length;
+}
+
+template <class Policy>
+int MicroOscMessage::nextAsMidi(const unsigned char **midiData)
+{
+  *midiData = NULL;
+  if (!check<Policy>('m', 4))
+    return 0;
+  *midiData = marker_;
+  advance(4);
+  return 4;
+}
+
+template <class Policy>
+void MicroOscMessage::skip()
+{
+  const unsigned char *data;
+  switch (*type_marker_)
+  {
+  case 'i':
+    nextAsInt<Policy>();
+    break;
+  case 'f':
+    nextAsFloat<Policy>();
+    break;
+  case 'd':
+    nextAsDouble<Policy>();
+    break;
+  case 't':
+    nextAsTimetag<Policy>();
+    break;
+  case 'h':
+    if (check<Policy>('h', 8))
+      advance(8);
+    break;
+  case 's':
+    nextAsString<Policy>();
+    break;
+  case 'b':
+    nextAsBlob<Policy>(&data);
+    break;
+  case 'm':
+    nextAsMidi<Policy>(&data);
+    break;
+  case 'T':
+  case 'F':
+  case 'N':
+  case 'I':
+  case '[':
+  case ']':
+    advance(0); // no data
+    break;
+  default:
+    if (Policy::checked)
+      error_ = MICRO_OSC_ERROR_TYPE;
+    else
+      advance(0);
+  }
+}
+
+template <class Policy>
+int MicroOscMessage::nextAsArray()
+{
+  if (!check<Policy>('[', 0))
+    return -1;
+
+  // count the elements of this array in the type tags
+  int count = 0;
+  int depth = 0;
+  const char *tag = type_marker_ + 1;
+  for (; *tag != '\0'; tag++)
+  {
+    if (*tag == ']')
+    {
+      if (depth == 0)
+        break;
+      depth--;
+    }
+    else
+    {
+      if (depth == 0)
+        count++;
+      if (*tag == '[')
+        depth++;
+    }
+  }
+  if (Policy::checked && *tag == '\0')
+  {
+    error_ = MICRO_OSC_ERROR_TYPE; // ']' is missing
+    return -1;
+  }
+
+  advance(0);
+  return count;
+}
+
+template <class Policy>
+void MicroOscMessage::nextAsArrayEnd()
+{
+  int depth = 0;
+  while (*type_marker_ != '\0' && (depth > 0 || *type_marker_ != ']'))
+  {
+    if (Policy::checked && error_ != 0)
+      return;
+    if (*type_marker_ == '[')
+      depth++;
+    else if (*type_marker_ == ']')
+      depth--;
+    skip<Policy>();
+  }
+  if (*type_marker_ == ']')
+    advance(0);
+}
+
+template <class Policy>
+size_t MicroOscMessage::nextAsFloatArray(float *values, size_t maxCount)
+{
+  if (nextAsArray<Policy>() < 0)
+    return 0;
+  size_t count = 0;
+  while (count < maxCount && *type_marker_ == 'f')
+    values[count++] = nextAsFloat<Policy>();
+  nextAsArrayEnd<Policy>();
+  return (Policy::checked && error_ != 0) ? 0 : count;
+}
+
+template <class Policy>
+size_t MicroOscMessage::nextAsIntArray(int32_t *values, size_t maxCount)
+{
+  if (nextAsArray<Policy>() < 0)
+    return 0;
+  size_t count = 0;
+  while (count < maxCount && *type_marker_ == 'i')
+    values[count++] = nextAsInt<Policy>();
+  nextAsArrayEnd<Policy>();
+  return (Policy::checked && error_ != 0) ? 0 : count;
+}
+
 const char *MicroOscMessage::getOscAddress()
 {
   return (const char *)buffer_;
@@ -111,43 +338,19 @@ bool MicroOscMessage::checkOscAddressAndTypeTags(const char *address, const char
   return (strcmp((const char *)buffer_, address) == 0) && (strcmp((const char *)format_, typetags) == 0);
 }
 
-uint32_t MicroOscMessage::nextAsBlob(const unsigned char **blob)
-{
-
-  const uint32_t iBE = *((uint32_t *)marker_);
-
-  uint32_t length = 0;
-  uint32_t i = swapBigEndian32(iBE);
-
-  if (marker_ + 4 + i <= buffer_ + buffer_length_)
-  {             // not bigger than stored data
-    length = i; // length of blob
-    *blob = marker_ + 4;
-    i = (i + 7) & ~0x3;
-    // marker_ += i;
-    advance(i);
-  }
-  else
-  {
-    length = 0;
-    *blob = NULL;
-  }
-
-  return length;
-}
-
-int MicroOscMessage::nextAsMidi(const unsigned char **midiData)
-{
+#define MICRO_OSC_INSTANTIATE_READERS(Policy)                                                   \
+  template int MicroOscMessage::parseMessage<Policy>(unsigned char *buffer, const size_t bufferLength); \
+  template int32_t MicroOscMessage::nextAsInt<Policy>();                                        \
+  template float MicroOscMessage::nextAsFloat<Policy>();                                        \
+  template double MicroOscMessage::nextAsDouble<Policy>();                                      \
+  template uint64_t MicroOscMessage::nextAsTimetag<Policy>();                                   \
+  template const char *MicroOscMessage::nextAsString<Policy>();                                 \
+  template uint32_t MicroOscMessage::nextAsBlob<Policy>(const unsigned char **blobData);        \
+  template int MicroOscMessage::nextAsMidi<Policy>(const unsigned char **midiData);            \
+  template int MicroOscMessage::nextAsArray<Policy>();                                          \
+  template void MicroOscMessage::nextAsArrayEnd<Policy>();                                      \
+  template size_t MicroOscMessage::nextAsFloatArray<Policy>(float *values, size_t maxCount);    \
+  template size_t MicroOscMessage::nextAsIntArray<Policy>(int32_t *values, size_t maxCount);
 
-  if (marker_ + 4 <= buffer_ + buffer_length_)
-  {
-    *midiData = marker_;
-    // marker += 4;
-    advance(4);
-    return 4;
-  }
-  else
-  {
-    return 0;
-  }
-}
+MICRO_OSC_INSTANTIATE_READERS(MicroOscChecked)
+MICRO_OSC_INSTANTIATE_READERS(MicroOscUnchecked)
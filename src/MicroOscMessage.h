@@ -5,6 +5,26 @@
 
 class MicroOsc; // FORWARD DECLARATION;
 
+/**
+ * Parse policies, given as a template parameter to the parser and to the readers.
+ * MicroOscChecked verifies the type tag and the buffer bounds of every read. After an error, every read returns 0 (or NULL).
+ * MicroOscUnchecked does not check anything and is meant for trusted links only.
+ */
+struct MicroOscChecked
+{
+	static const bool checked = true;
+};
+
+struct MicroOscUnchecked
+{
+	static const bool checked = false;
+};
+
+#define MICRO_OSC_ERROR_NO_TYPE_TAGS -1
+#define MICRO_OSC_ERROR_TYPE_TAGS_NOT_TERMINATED -2
+#define MICRO_OSC_ERROR_TYPE -3   // the type tag of the argument does not match the read
+#define MICRO_OSC_ERROR_BOUNDS -4 // the argument exceeds the buffer
+
 class MicroOscMessage
 {
 
@@ -26,17 +46,25 @@ protected:
 	
 	char *format_;			 // a pointer to the format field
 	char *format_marker_;	 // the current format read head
+	char *type_marker_;		 // the type tag of the next argument
 	unsigned char *marker_;	 // the current read head
 	unsigned char *buffer_;	 // the original message data (also points to the address)
 	uint32_t buffer_length_; // length of the buffer data
+	int8_t error_ = 0;		 // sticky error of the checked policy
 
 private:
 	inline void advance(uint32_t bytes)
 	{
 		marker_ += bytes;
-		//format_marker_++;
+		type_marker_++;
 	}
 
+	template <class Policy>
+	bool check(char typeTag, size_t bytes);
+
+	template <class Policy>
+	void skip();
+
 public:
 	MicroOscMessage();
 
@@ -44,9 +72,20 @@ public:
 	 * Parses an OSC message from a buffer.
 	 * Returns 0 if there is no error. An error code (a negative number) otherwise.
 	 * The contents of the buffer is NOT copied.
+	 * With MicroOscUnchecked, the buffer must contain a valid message.
 	 */
+	template <class Policy = MicroOscChecked>
 	int parseMessage(unsigned char  *buffer, const size_t bufferLength);
 
+	/**
+	 * Returns 0 if all the arguments were read without error. An error code (a negative number) otherwise.
+	 * Errors are only detected by the MicroOscChecked policy and stay until the next message.
+	 */
+	int getError()
+	{
+		return error_;
+	}
+
 	/**
 	 * Returns type tags 
 	 * The returned value is valid only until the next received message. DO NOT STORE IT.
@@ -67,6 +106,23 @@ public:
 	 */
 	bool checkOscAddress(const char *address);
 
+	/**
+	 * Returns a pointer to the raw bytes of the message (address, type tags and arguments) as they were received.
+	 * The returned value is valid only until the next received message. DO NOT STORE IT.
+	 */
+	const unsigned char * getRawMessage() const
+	{
+		return buffer_;
+	}
+
+	/**
+	 * Returns the length in bytes of the raw message.
+	 */
+	size_t getRawMessageLength() const
+	{
+		return buffer_length_;
+	}
+
 	/**
 	 * Returns `true` if the address and argument type tags match exactly.
 	 */
@@ -111,28 +167,45 @@ public:
 		return checkOscAddressAndTypeTags(address, typetags);
 	};
 
+	/*
+	 * The following readers check the type tag and the buffer bounds by default (MicroOscChecked).
+	 * On trusted links, use the MicroOscUnchecked policy to skip all checks: `nextAsInt<MicroOscUnchecked>()`
+	 * Arguments without data (T, F, N and I) are stepped over.
+	 */
+
 	/**
 	 * Returns the next argument as a 32-bit int.
-	 * Does not check buffer bounds.
+	 * Returns 0 if there was an error.
 	 */
+	template <class Policy = MicroOscChecked>
 	int32_t nextAsInt();
 
 	/**
 	 * Returns the next argument as a 32-bit float.
-	 * Does not check buffer bounds.
+	 * Returns 0 if there was an error.
 	 */
+	template <class Policy = MicroOscChecked>
 	float nextAsFloat();
 
 	/**
 	 * Returns the next argument as a 64-bit double.
-	 * Does not check buffer bounds.
+	 * Returns 0 if there was an error.
 	 */
+	template <class Policy = MicroOscChecked>
 	double nextAsDouble();
 
+	/**
+	 * Returns the next argument as a 64-bit OSC timetag (NTP format: seconds since 1900 in the upper 32 bits, fraction in the lower 32 bits).
+	 * Returns 0 if there was an error.
+	 */
+	template <class Policy = MicroOscChecked>
+	uint64_t nextAsTimetag();
+
 	/**
 	 * Treats the next argument as a C string and returns a pointer to the data,
-	 * or NULL if the buffer length is exceeded.
+	 * or NULL if there was an error.
 	 */
+	template <class Policy = MicroOscChecked>
 	const char *nextAsString();
 
 	/**
@@ -140,14 +213,51 @@ public:
 	 * The pointer is NULL if there was an error.
 	 * Returns the length of the byte blob. Returns 0 if there was an error.
 	 */
+	template <class Policy = MicroOscChecked>
 	uint32_t nextAsBlob(const uint8_t **blobData);
 
 	/**
 	 * Treats the next value as MIDI and fills a pointer with the address to the MIDI data.
-	 * The pointer is NULL if the OSC bounds are exceeded.
+	 * The pointer is NULL if there was an error.
 	 * MIDI data always has a length of 4. Bytes from MSB to LSB are: port id, status byte, data1, data2
 	 */
+	template <class Policy = MicroOscChecked>
 	int nextAsMidi(const uint8_t **midiData);
+
+	/*
+	 * Arrays (OSC 1.1): the elements between '[' and ']' are read with the readers above.
+	 */
+
+	/**
+	 * Enters the array that is the next argument and returns its number of elements
+	 * (a nested array counts as one element). Returns -1 if the next argument is not an array.
+	 */
+	template <class Policy = MicroOscChecked>
+	int nextAsArray();
+
+	/**
+	 * Returns `true` if there are no elements left in the current array.
+	 */
+	bool isArrayEnd()
+	{
+		return *type_marker_ == ']' || *type_marker_ == '\0';
+	}
+
+	/**
+	 * Skips the elements left in the current array and leaves it.
+	 */
+	template <class Policy = MicroOscChecked>
+	void nextAsArrayEnd();
+
+	/**
+	 * Reads the next argument, an array of floats (or ints), into values.
+	 * Reads at most maxCount elements and skips the rest of the array.
+	 * Returns the number of elements read, 0 if there was an error.
+	 */
+	template <class Policy = MicroOscChecked>
+	size_t nextAsFloatArray(float *values, size_t maxCount);
+	template <class Policy = MicroOscChecked>
+	size_t nextAsIntArray(int32_t *values, size_t maxCount);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "MicroOscQueue.h"
+
+MicroOscQueue::MicroOscQueue(uint8_t *controlBuffer, size_t controlSize, uint8_t *bulkBuffer, size_t bulkSize)
+{
+  rings_[MICRO_OSC_PRIORITY_CONTROL].data = controlBuffer;
+  rings_[MICRO_OSC_PRIORITY_CONTROL].size = controlSize;
+  rings_[MICRO_OSC_PRIORITY_BULK].data = bulkBuffer;
+  rings_[MICRO_OSC_PRIORITY_BULK].size = bulkSize;
+  for (int i = 0; i < MICRO_OSC_PRIORITY_CLASSES; i++)
+  {
+    rings_[i].head = 0;
+    rings_[i].tail = 0;
+    rings_[i].used = 0;
+    rings_[i].frames = 0;
+  }
+}
+
+void MicroOscQueue::put(Ring *ring, uint8_t b)
+{
+  ring->data[ring->head] = b;
+  ring->head = (ring->head + 1) % ring->size;
+  ring->used++;
+}
+
+uint8_t MicroOscQueue::get(Ring *ring)
+{
+  uint8_t b = ring->data[ring->tail];
+  ring->tail = (ring->tail + 1) % ring->size;
+  ring->used--;
+  return b;
+}
+
+void MicroOscQueue::beginFrame(uint8_t priority)
+{
+  if (priority >= MICRO_OSC_PRIORITY_CLASSES)
+    priority = MICRO_OSC_PRIORITY_CLASSES - 1;
+  writing_ = &rings_[priority];
+  frame_start_ = writing_->head;
+  frame_length_ = 0;
+  frame_bytes_ = 0;
+  overflow_ = (writing_->size - writing_->used < 2);
+  if (!overflow_)
+  {
+    // room for the length, written by endFrame()
+    put(writing_, 0);
+    put(writing_, 0);
+    frame_bytes_ = 2;
+  }
+}
+
+size_t MicroOscQueue::write(uint8_t b)
+{
+  if (writing_ == NULL || overflow_)
+    return 0;
+  if (writing_->used >= writing_->size || frame_length_ >= 0xFFFF)
+  {
+    overflow_ = true;
+    return 0;
+  }
+  put(writing_, b);
+  frame_length_++;
+  frame_bytes_++;
+  return 1;
+}
+
+size_t MicroOscQueue::write(const uint8_t *buffer, size_t size)
+{
+  if (writing_ == NULL || overflow_)
+    return 0;
+  if (writing_->size - writing_->used < size || frame_length_ + size > 0xFFFF)
+  {
+    overflow_ = true;
+    return 0;
+  }
+  // copy in at most two contiguous runs
+  size_t first = writing_->size - writing_->head;
+  if (first > size)
+    first = size;
+  memcpy(writing_->data + writing_->head, buffer, first);
+  memcpy(writing_->data, buffer + first, size - first);
+  writing_->head = (writing_->head + size) % writing_->size;
+  writing_->used += size;
+  frame_length_ += size;
+  frame_bytes_ += size;
+  return size;
+}
+
+void MicroOscQueue::endFrame()
+{
+  if (writing_ == NULL)
+    return;
+  if (overflow_)
+  {
+    // roll back the partial packet (length included if it was written)
+    writing_->head = frame_start_;
+    writing_->used -= frame_bytes_;
+    dropped_++;
+  }
+  else
+  {
+    writing_->data[frame_start_] = frame_length_ & 0xFF;
+    writing_->data[(frame_start_ + 1) % writing_->size] = frame_length_ >> 8;
+    writing_->frames++;
+  }
+  writing_ = NULL;
+}
+
+size_t MicroOscQueue::beginRead()
+{
+  if (reading_ != NULL)
+    return remaining_;
+  for (int i = 0; i < MICRO_OSC_PRIORITY_CLASSES; i++)
+  {
+    if (rings_[i].frames > 0)
+    {
+      reading_ = &rings_[i];
+      remaining_ = get(reading_);
+      remaining_ |= ((size_t)get(reading_)) << 8;
+      if (remaining_ == 0)
+      {
+        // empty packet, skip it
+        reading_->frames--;
+        reading_ = NULL;
+        i--;
+        continue;
+      }
+      return remaining_;
+    }
+  }
+  return 0;
+}
+
+size_t MicroOscQueue::peekRead(const uint8_t **data)
+{
+  if (reading_ == NULL)
+    return 0;
+  *data = reading_->data + reading_->tail;
+  size_t contiguous = reading_->size - reading_->tail;
+  return (contiguous < remaining_) ? contiguous : remaining_;
+}
+
+bool MicroOscQueue::consume(size_t length)
+{
+  if (reading_ == NULL)
+    return false;
+  if (length > remaining_)
+    length = remaining_;
+  reading_->tail = (reading_->tail + length) % reading_->size;
+  reading_->used -= length;
+  remaining_ -= length;
+  if (remaining_ > 0)
+    return false;
+  reading_->frames--;
+  reading_ = NULL;
+  return true;
+}
+
+bool MicroOscQueue::isEmpty()
+{
+  for (int i = 0; i < MICRO_OSC_PRIORITY_CLASSES; i++)
+  {
+    if (rings_[i].frames > 0)
+      return false;
+  }
+  return reading_ == NULL;
+}
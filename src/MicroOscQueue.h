@@ -0,0 +1,117 @@
+/* MicroOscQueue
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_QUEUE_
+#define _MICRO_OSC_QUEUE_
+
+#include <Arduino.h>
+#include "Print.h"
+
+#define MICRO_OSC_PRIORITY_CONTROL 0
+#define MICRO_OSC_PRIORITY_BULK 1
+#define MICRO_OSC_PRIORITY_CLASSES 2
+
+/**
+ * Fixed size transmit queue of encoded OSC packets with one ring per priority class.
+ * Packets are stored as a 16-bit length followed by the encoded bytes.
+ * A packet that does not fit is dropped as a whole.
+ * Use MicroOscTransmitQueue<CONTROL_SIZE, BULK_SIZE> to reserve the memory.
+ */
+class MicroOscQueue : public Print
+{
+	struct Ring
+	{
+		uint8_t *data;
+		size_t size;
+		size_t head;   // where the next byte is written
+		size_t tail;   // where the next byte is read
+		size_t used;   // bytes in the ring, including the packet being written
+		size_t frames; // complete packets in the ring
+	};
+
+	Ring rings_[MICRO_OSC_PRIORITY_CLASSES];
+
+	Ring *writing_ = NULL; // ring of the packet being written
+	size_t frame_start_;   // position of the length of the packet being written
+	size_t frame_length_;
+	size_t frame_bytes_; // bytes of the packet in the ring, length included
+	bool overflow_;
+
+	Ring *reading_ = NULL; // ring of the packet being read
+	size_t remaining_;     // bytes left to read in that packet
+
+	uint32_t dropped_ = 0;
+
+private:
+	void put(Ring *ring, uint8_t b);
+	uint8_t get(Ring *ring);
+
+public:
+	MicroOscQueue(uint8_t *controlBuffer, size_t controlSize, uint8_t *bulkBuffer, size_t bulkSize);
+
+	size_t write(uint8_t b) override;
+	size_t write(const uint8_t *buffer, size_t size) override;
+
+	/**
+	 * Starts writing a packet in the ring of the priority class.
+	 */
+	void beginFrame(uint8_t priority);
+
+	/**
+	 * Commits the packet being written, or drops it if it did not fit.
+	 */
+	void endFrame();
+
+	/**
+	 * Starts reading the next packet (highest priority class first) if no packet is being read.
+	 * Returns the number of bytes left to read in the current packet, 0 if the queue is empty.
+	 */
+	size_t beginRead();
+
+	/**
+	 * Sets data to the next contiguous bytes of the packet being read and returns their count.
+	 */
+	size_t peekRead(const uint8_t **data);
+
+	/**
+	 * Removes length bytes of the packet being read. Returns true when the packet is complete.
+	 */
+	bool consume(size_t length);
+
+	/**
+	 * Returns true if a packet is being read (partially sent).
+	 */
+	bool isReading()
+	{
+		return reading_ != NULL;
+	}
+
+	/**
+	 * Returns true if there is no complete packet waiting to be sent.
+	 */
+	bool isEmpty();
+
+	/**
+	 * Returns the number of packets that were dropped because the queue was full.
+	 */
+	uint32_t getDroppedCount()
+	{
+		return dropped_;
+	}
+};
+
+template <const size_t CONTROL_SIZE, const size_t BULK_SIZE = CONTROL_SIZE>
+class MicroOscTransmitQueue : public MicroOscQueue
+{
+protected:
+	uint8_t control_buffer_[CONTROL_SIZE];
+	uint8_t bulk_buffer_[BULK_SIZE];
+
+public:
+	MicroOscTransmitQueue() : MicroOscQueue(control_buffer_, CONTROL_SIZE, bulk_buffer_, BULK_SIZE)
+	{
+	}
+};
+
+#endif // _MICRO_OSC_QUEUE_
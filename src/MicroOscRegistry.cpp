@@ -0,0 +1,224 @@
+#include "MicroOscRegistry.h"
+#include "MicroOscUtility.h"
+
+MicroOscRegistry::MicroOscRegistry(MicroOscParameter *parameters, uint32_t *dirty, size_t capacity) : parameters_(parameters), dirty_(dirty), capacity_(capacity)
+{
+  memset(dirty_, 0, ((capacity + 31) / 32) * sizeof(uint32_t));
+}
+
+int MicroOscRegistry::add(const char *address, void *variable, char type)
+{
+  if (count_ >= capacity_)
+    return -1;
+  MicroOscParameter &parameter = parameters_[count_];
+  parameter.address = address;
+  parameter.variable = variable;
+  parameter.type = type;
+  parameter.hash = microOscFoldHash(microOscHash(address));
+  parameter.sent = read(parameter);
+  setDirty(count_);
+  return (int)count_++;
+}
+
+int MicroOscRegistry::add(const char *address, int32_t &variable)
+{
+  return add(address, &variable, 'i');
+}
+
+int MicroOscRegistry::add(const char *address, float &variable)
+{
+  return add(address, &variable, 'f');
+}
+
+int MicroOscRegistry::add(const char *address, bool &variable)
+{
+  return add(address, &variable, 'T');
+}
+
+uint32_t MicroOscRegistry::read(const MicroOscParameter &parameter)
+{
+  uint32_t bits = 0;
+  if (parameter.type == 'T')
+    bits = *(bool *)parameter.variable ? 1 : 0;
+  else
+    memcpy(&bits, parameter.variable, 4);
+  return bits;
+}
+
+void MicroOscRegistry::setDirty(size_t index)
+{
+  if (!isDirty(index))
+  {
+    dirty_[index / 32] |= (1UL << (index % 32));
+    dirty_count_++;
+  }
+}
+
+void MicroOscRegistry::clearDirty(size_t index)
+{
+  if (isDirty(index))
+  {
+    dirty_[index / 32] &= ~(1UL << (index % 32));
+    dirty_count_--;
+  }
+}
+
+bool MicroOscRegistry::dispatch(MicroOscMessage &msg)
+{
+  const char *address = msg.getOscAddress();
+  uint16_t hash = microOscFoldHash(microOscHash(address));
+
+  for (size_t i = 0; i < count_; i++)
+  {
+    MicroOscParameter &parameter = parameters_[i];
+    if (parameter.hash != hash || strcmp(parameter.address, address) != 0)
+      continue;
+
+    // convert the first argument to the type of the variable
+    float f = 0;
+    int32_t n = 0;
+    bool fromFloat = false;
+    switch (msg.getTypeTags()[0])
+    {
+    case 'i':
+      n = msg.nextAsInt();
+      f = (float)n;
+      break;
+    case 'f':
+      f = msg.nextAsFloat();
+      fromFloat = true;
+      break;
+    case 'T':
+      n = 1;
+      f = 1;
+      break;
+    case 'F':
+      break;
+    default:
+      return true; // ignore the value but the address was handled
+    }
+
+    switch (parameter.type)
+    {
+    case 'i':
+      if (fromFloat)
+      {
+        // converting NaN or a float out of the range of int32_t is undefined
+        if (f != f)
+          return true;
+        if (f >= 2147483648.0f)
+          n = INT32_MAX;
+        else if (f <= -2147483648.0f)
+          n = INT32_MIN;
+        else
+          n = (int32_t)f;
+      }
+      *(int32_t *)parameter.variable = n;
+      break;
+    case 'f':
+      *(float *)parameter.variable = f;
+      break;
+    case 'T':
+      *(bool *)parameter.variable = (n != 0 || f != 0);
+      break;
+    }
+    parameter.sent = read(parameter);
+    clearDirty(i);
+    return true;
+  }
+  return false;
+}
+
+void MicroOscRegistry::markDirty(size_t index)
+{
+  if (index < count_)
+    setDirty(index);
+}
+
+void MicroOscRegistry::markDirty(const void *variable)
+{
+  for (size_t i = 0; i < count_; i++)
+  {
+    if (parameters_[i].variable == variable)
+    {
+      setDirty(i);
+      return;
+    }
+  }
+}
+
+size_t MicroOscRegistry::scan()
+{
+  for (size_t i = 0; i < count_; i++)
+  {
+    if (read(parameters_[i]) != parameters_[i].sent)
+      setDirty(i);
+  }
+  return dirty_count_;
+}
+
+void MicroOscRegistry::snapshot()
+{
+  for (size_t i = 0; i < count_; i++)
+    setDirty(i);
+}
+
+size_t MicroOscRegistry::sync(MicroOsc &osc, size_t maxBytes)
+{
+  if (dirty_count_ == 0)
+    return 0;
+
+  size_t sent = 0;
+  size_t bytes = 0;
+#ifndef MICRO_OSC_NO_BUNDLES
+  // the parameters are added to a bundle opened by the caller
+  bool wrap = !osc.isBundleOpen();
+  if (wrap)
+    osc.bundleBegin();
+#endif
+
+  for (size_t n = 0; n < count_ && dirty_count_ > 0; n++)
+  {
+    size_t i = cursor_;
+    cursor_ = (cursor_ + 1 < count_) ? cursor_ + 1 : 0;
+    if (!isDirty(i))
+      continue;
+
+    MicroOscParameter &parameter = parameters_[i];
+    // element size, address, type tags and argument
+    size_t size = 4 + ((strlen(parameter.address) + 4) & ~(size_t)3) + 4 + ((parameter.type == 'T') ? 0 : 4);
+    if (sent > 0 && bytes + size > maxBytes)
+    {
+      // continue with this parameter the next time
+      cursor_ = i;
+      break;
+    }
+
+    uint32_t value = read(parameter);
+    switch (parameter.type)
+    {
+    case 'i':
+      osc.sendInt(parameter.address, *(int32_t *)parameter.variable);
+      break;
+    case 'f':
+      osc.sendFloat(parameter.address, *(float *)parameter.variable);
+      break;
+    case 'T':
+      if (value)
+        osc.sendTrue(parameter.address);
+      else
+        osc.sendFalse(parameter.address);
+      break;
+    }
+    parameter.sent = value;
+    clearDirty(i);
+    bytes += size;
+    sent++;
+  }
+
+#ifndef MICRO_OSC_NO_BUNDLES
+  if (wrap)
+    osc.bundleEnd();
+#endif
+  return sent;
+}
@@ -0,0 +1,116 @@
+/* MicroOscRegistry
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_REGISTRY_
+#define _MICRO_OSC_REGISTRY_
+
+#include <Arduino.h>
+#include "MicroOsc.h"
+
+/**
+ * An OSC address bound to a variable.
+ */
+struct MicroOscParameter
+{
+	const char *address;
+	void *variable;
+	uint32_t sent;  // bits of the value last sent or received
+	uint16_t hash;  // hash of the address, compared before the address
+	char type;      // 'i', 'f' or 'T' (bool)
+};
+
+/**
+ * Binds OSC addresses to int32_t, float and bool variables.
+ * dispatch() writes received values to the variables. Local changes are marked dirty with
+ * markDirty() or detected with scan(), and sync() sends only the dirty parameters in bundles.
+ * Use MicroOscParameterRegistry<CAPACITY> to reserve the memory.
+ */
+class MicroOscRegistry
+{
+	MicroOscParameter *parameters_;
+	uint32_t *dirty_; // one bit per parameter
+	size_t capacity_;
+	size_t count_ = 0;
+	size_t cursor_ = 0; // where the next sync() starts
+	size_t dirty_count_ = 0;
+
+private:
+	int add(const char *address, void *variable, char type);
+	uint32_t read(const MicroOscParameter &parameter);
+	void setDirty(size_t index);
+	void clearDirty(size_t index);
+	bool isDirty(size_t index)
+	{
+		return dirty_[index / 32] & (1UL << (index % 32));
+	}
+
+public:
+	MicroOscRegistry(MicroOscParameter *parameters, uint32_t *dirty, size_t capacity);
+
+	/**
+	 * Binds address to a variable. The address is not copied and must stay valid.
+	 * Returns the index of the parameter, -1 if the registry is full.
+	 * The parameter is dirty so it is sent by the next sync().
+	 */
+	int add(const char *address, int32_t &variable);
+	int add(const char *address, float &variable);
+	int add(const char *address, bool &variable);
+
+	/**
+	 * If the address of msg is registered, writes its first argument to the variable and returns true.
+	 * Accepts i, f, T and F arguments for every type of variable.
+	 * A received value is not sent back by sync().
+	 */
+	bool dispatch(MicroOscMessage &msg);
+
+	/**
+	 * Marks a parameter as changed.
+	 */
+	void markDirty(size_t index);
+	void markDirty(const void *variable);
+
+	/**
+	 * Compares every variable with the value last sent or received and marks the changed ones.
+	 * Returns the number of dirty parameters.
+	 */
+	size_t scan();
+
+	/**
+	 * Marks every parameter so the following sync() calls send the complete state (after a reconnection for example).
+	 */
+	void snapshot();
+
+	/**
+	 * Sends the dirty parameters, in one bundle split to the size of the bundle buffer of osc (see MicroOsc::setBundleBuffer()).
+	 * If a bundle is already open (MicroOsc::bundleBegin()), they are added to it and it is left open.
+	 * At most maxBytes of messages are sent per call, the following call continues where this one stopped.
+	 * Returns the number of parameters sent.
+	 */
+	size_t sync(MicroOsc &osc, size_t maxBytes = SIZE_MAX);
+
+	size_t getDirtyCount()
+	{
+		return dirty_count_;
+	}
+
+	size_t count()
+	{
+		return count_;
+	}
+};
+
+template <const size_t CAPACITY>
+class MicroOscParameterRegistry : public MicroOscRegistry
+{
+protected:
+	MicroOscParameter parameters_[CAPACITY];
+	uint32_t dirty_[(CAPACITY + 31) / 32];
+
+public:
+	MicroOscParameterRegistry() : MicroOscRegistry(parameters_, dirty_, CAPACITY)
+	{
+	}
+};
+
+#endif // _MICRO_OSC_REGISTRY_
@@ -0,0 +1,230 @@
+#include "MicroOscShm.h"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MicroOscUtility.h"
+
+#define MICRO_OSC_SHM_MAGIC 0x4853534FUL // "OSSH"
+
+// Layout of the shared memory object: header, the two rings, then the slots of each ring.
+// Every slot is a 32-bit length followed by the packet.
+struct MicroOscShmHeader
+{
+  uint32_t magic;
+  uint32_t slot_size;
+  uint32_t slot_count;
+  uint8_t pad_[52];
+  MicroOscShmRing rings[2]; // 0: sent by the creator, 1: sent by the other process
+};
+
+MicroOscShmChannel::~MicroOscShmChannel()
+{
+  close();
+}
+
+bool MicroOscShmChannel::map(int fd, size_t size)
+{
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (memory == MAP_FAILED)
+    return false;
+  memory_ = (uint8_t *)memory;
+  memory_size_ = size;
+  return true;
+}
+
+void MicroOscShmChannel::attach(bool creator)
+{
+  MicroOscShmHeader *header = (MicroOscShmHeader *)memory_;
+  slot_size_ = header->slot_size;
+  slot_count_ = header->slot_count;
+  uint8_t *slots = memory_ + sizeof(MicroOscShmHeader);
+  size_t ring_bytes = (size_t)slot_size_ * slot_count_;
+  tx_ = &header->rings[creator ? 0 : 1];
+  rx_ = &header->rings[creator ? 1 : 0];
+  tx_slots_ = slots + (creator ? 0 : ring_bytes);
+  rx_slots_ = slots + (creator ? ring_bytes : 0);
+}
+
+bool MicroOscShmChannel::create(const char *name, uint32_t slotSize, uint32_t slotCount)
+{
+  close();
+  slotSize = (slotSize + 3) & ~3UL;
+  // head and tail wrap at 2^32, the slot count must divide it
+  if (slotSize <= 4 || slotCount == 0 || (slotCount & (slotCount - 1)) != 0)
+    return false;
+
+  int fd = shm_open(name, O_CREAT | O_TRUNC | O_RDWR, 0600);
+  if (fd < 0)
+    return false;
+  size_t size = sizeof(MicroOscShmHeader) + 2 * (size_t)slotSize * slotCount;
+  if (ftruncate(fd, size) != 0)
+  {
+    ::close(fd);
+    return false;
+  }
+  if (!map(fd, size))
+    return false;
+
+  // the object is zeroed by ftruncate(), the magic is written last
+  MicroOscShmHeader *header = (MicroOscShmHeader *)memory_;
+  header->slot_size = slotSize;
+  header->slot_count = slotCount;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = MICRO_OSC_SHM_MAGIC;
+  attach(true);
+  return true;
+}
+
+bool MicroOscShmChannel::open(const char *name)
+{
+  close();
+  int fd = shm_open(name, O_RDWR, 0600);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MicroOscShmHeader))
+  {
+    ::close(fd);
+    return false;
+  }
+  if (!map(fd, st.st_size))
+    return false;
+
+  MicroOscShmHeader *header = (MicroOscShmHeader *)memory_;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (header->magic != MICRO_OSC_SHM_MAGIC || header->slot_count == 0 || (header->slot_count & (header->slot_count - 1)) != 0 ||
+    sizeof(MicroOscShmHeader) + 2 * (size_t)header->slot_size * header->slot_count != memory_size_)
+  {
+    close();
+    return false;
+  }
+  attach(false);
+  return true;
+}
+
+void MicroOscShmChannel::close()
+{
+  if (memory_ != NULL)
+  {
+    munmap(memory_, memory_size_);
+    memory_ = NULL;
+    tx_ = rx_ = NULL;
+    slot_ = NULL;
+  }
+}
+
+void MicroOscShmChannel::unlink(const char *name)
+{
+  shm_unlink(name);
+}
+
+/***********
+  TRANSMIT
+************/
+
+bool MicroOscShmChannel::canWrite()
+{
+  if (tx_ == NULL)
+    return false;
+  uint32_t head = tx_->head.load(std::memory_order_relaxed);
+  return head - tx_->tail.load(std::memory_order_acquire) < slot_count_;
+}
+
+void MicroOscShmChannel::beginPacket()
+{
+  slot_length_ = 0;
+  overflow_ = false;
+  slot_ = NULL;
+  if (canWrite())
+  {
+    uint32_t head = tx_->head.load(std::memory_order_relaxed);
+    slot_ = tx_slots_ + (size_t)(head & (slot_count_ - 1)) * slot_size_;
+  }
+}
+
+void MicroOscShmChannel::endPacket()
+{
+  if (slot_ == NULL || overflow_)
+  {
+    dropped_++;
+    slot_ = NULL;
+    return;
+  }
+  memcpy(slot_, &slot_length_, 4);
+  slot_ = NULL;
+
+  // publish the slot, then wake the receiver if it sleeps
+  tx_->head.fetch_add(1, std::memory_order_seq_cst);
+  if (tx_->waiting.load(std::memory_order_seq_cst))
+    microOscFutexWake(&tx_->head);
+}
+
+size_t MicroOscShmChannel::write(uint8_t b)
+{
+  return write(&b, 1);
+}
+
+size_t MicroOscShmChannel::write(const uint8_t *buffer, size_t size)
+{
+  if (slot_ == NULL)
+    return 0;
+  if (size > slot_size_ - 4 - slot_length_)
+  {
+    overflow_ = true;
+    return 0;
+  }
+  memcpy(slot_ + 4 + slot_length_, buffer, size);
+  slot_length_ += size;
+  return size;
+}
+
+/***********
+  RECEIVE
+************/
+
+uint32_t MicroOscShmChannel::available()
+{
+  if (rx_ == NULL)
+    return 0;
+  uint32_t count = rx_->head.load(std::memory_order_acquire) - rx_->tail.load(std::memory_order_relaxed);
+  return (count <= slot_count_) ? count : slot_count_;
+}
+
+unsigned char *MicroOscShmChannel::peek(size_t *length)
+{
+  if (available() == 0)
+    return NULL;
+  uint32_t tail = rx_->tail.load(std::memory_order_relaxed);
+  uint8_t *slot = rx_slots_ + (size_t)(tail & (slot_count_ - 1)) * slot_size_;
+  uint32_t slot_length;
+  memcpy(&slot_length, slot, 4);
+  // the length is written by the other process, never trust it
+  *length = (slot_length <= slot_size_ - 4) ? slot_length : 0;
+  return slot + 4;
+}
+
+void MicroOscShmChannel::release()
+{
+  if (available() > 0)
+    rx_->tail.fetch_add(1, std::memory_order_release);
+}
+
+bool MicroOscShmChannel::wait(uint32_t timeoutMicros)
+{
+  if (rx_ == NULL)
+    return false;
+  uint32_t head = rx_->head.load(std::memory_order_seq_cst);
+  if (head != rx_->tail.load(std::memory_order_relaxed))
+    return true;
+
+  microOscFutexWait(&rx_->head, &rx_->waiting, head, timeoutMicros);
+  return available() > 0;
+}
+
+#endif // __linux__
@@ -0,0 +1,224 @@
+/* MicroOscShm
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_SHM_
+#define _MICRO_OSC_SHM_
+
+#include <MicroOsc.h>
+
+#if defined(__linux__)
+
+#include <atomic>
+
+/**
+ * One direction of a shared memory channel: a single producer, single consumer ring of fixed size slots.
+ * head and tail count slots since the creation of the channel and are only written by one side each.
+ * waiting is set by a receiver sleeping on head with a futex.
+ */
+struct MicroOscShmRing
+{
+	std::atomic<uint32_t> head;
+	uint8_t pad0_[60];
+	std::atomic<uint32_t> tail;
+	uint8_t pad1_[60];
+	std::atomic<uint32_t> waiting;
+	uint8_t pad2_[60];
+};
+
+/**
+ * POSIX shared memory channel between two processes of the same host. Linux only.
+ * The process that creates the channel and the one that opens it each send in their own ring.
+ * Messages are encoded straight into a slot of the ring (write() copies into the slot),
+ * and received messages are parsed in place in their slot.
+ */
+class MicroOscShmChannel : public Print
+{
+	uint8_t *memory_ = NULL;
+	size_t memory_size_ = 0;
+	uint32_t slot_size_ = 0;
+	uint32_t slot_count_ = 0;
+	MicroOscShmRing *tx_ = NULL;
+	MicroOscShmRing *rx_ = NULL;
+	uint8_t *tx_slots_ = NULL;
+	uint8_t *rx_slots_ = NULL;
+
+	uint8_t *slot_ = NULL; // slot being written, NULL if the ring was full
+	uint32_t slot_length_ = 0;
+	bool overflow_ = false;
+	uint32_t dropped_ = 0;
+
+private:
+	bool map(int fd, size_t size);
+	void attach(bool creator);
+
+public:
+	~MicroOscShmChannel();
+
+	/**
+	 * Creates (or replaces) the shared memory object name ("/my-channel") with slotCount slots
+	 * of slotSize bytes in each direction. slotSize is the largest packet, plus 4 bytes.
+	 * slotCount must be a power of two. Returns false otherwise.
+	 */
+	bool create(const char *name, uint32_t slotSize, uint32_t slotCount);
+
+	/**
+	 * Opens a channel created by another process.
+	 */
+	bool open(const char *name);
+
+	/**
+	 * Unmaps the channel. The shared memory object stays until unlink().
+	 */
+	void close();
+
+	/**
+	 * Removes the shared memory object name.
+	 */
+	static void unlink(const char *name);
+
+	bool isOpen()
+	{
+		return memory_ != NULL;
+	}
+
+	// TRANSMIT
+	bool canWrite();
+	void beginPacket();
+	void endPacket();
+	size_t write(uint8_t b) override;
+	size_t write(const uint8_t *buffer, size_t size) override;
+	using Print::write;
+
+	/**
+	 * Returns the number of packets dropped because the ring was full or a packet was larger than a slot.
+	 */
+	uint32_t getDroppedCount()
+	{
+		return dropped_;
+	}
+
+	// RECEIVE
+	/**
+	 * Returns the number of packets waiting in the receive ring.
+	 */
+	uint32_t available();
+
+	/**
+	 * Returns the oldest received packet, in place in its slot, or NULL if there is none.
+	 * The packet is valid until release().
+	 */
+	unsigned char *peek(size_t *length);
+
+	/**
+	 * Frees the slot of the oldest received packet for the sender.
+	 */
+	void release();
+
+	/**
+	 * Sleeps until a packet is received or timeoutMicros is over.
+	 * Returns true if a packet is available.
+	 */
+	bool wait(uint32_t timeoutMicros);
+};
+
+template <class MicroOscPolicy = MicroOscChecked>
+class MicroOscShm : public MicroOsc
+{
+protected:
+	MicroOscShmChannel channel_;
+
+protected:
+	void transportBegin()
+	{
+		channel_.beginPacket();
+	}
+	void transportEnd()
+	{
+		channel_.endPacket();
+	}
+	bool transportReady()
+	{
+		return channel_.isOpen();
+	}
+#ifndef MICRO_OSC_NO_QUEUE
+	size_t transportAvailableForWrite() override
+	{
+		return channel_.canWrite() ? SIZE_MAX : 0;
+	}
+#endif
+
+	template <class Callback>
+	void receive(Callback callback)
+	{
+		update();
+
+		// only the packets already received, so a fast sender can not keep us here
+		uint32_t count = channel_.available();
+		if (receiveBudget > 0 && count > receiveBudget)
+			count = receiveBudget;
+		while (count-- > 0)
+		{
+			size_t packetLength;
+			unsigned char *packet = channel_.peek(&packetLength);
+			MicroOsc::parseMessages<MicroOscPolicy>(callback, packet, packetLength);
+			channel_.release();
+		}
+		MicroOsc::template dispatchCoalesced<MicroOscPolicy>(callback);
+	}
+
+public:
+	MicroOscShm() : MicroOsc(&channel_)
+	{
+	}
+
+	/**
+	 * See MicroOscShmChannel::create().
+	 */
+	bool create(const char *name, uint32_t slotSize = 1024, uint32_t slotCount = 64)
+	{
+		return channel_.create(name, slotSize, slotCount);
+	}
+
+	/**
+	 * See MicroOscShmChannel::open().
+	 */
+	bool open(const char *name)
+	{
+		return channel_.open(name);
+	}
+
+	void close()
+	{
+		channel_.close();
+	}
+
+	/**
+	 * Sleeps until a packet is received or timeoutMicros is over. Returns true if a packet is available.
+	 */
+	bool wait(uint32_t timeoutMicros)
+	{
+		return channel_.wait(timeoutMicros);
+	}
+
+	uint32_t getDroppedCount()
+	{
+		return channel_.getDroppedCount();
+	}
+
+	void onOscMessageReceived(MicroOscCallback callback) override
+	{
+		receive(callback);
+	}
+
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+	void onOscMessageReceived(MicroOscCallbackWithSource callback) override
+	{
+		receive(callback);
+	}
+#endif
+};
+
+#endif // __linux__
+
+#endif // _MICRO_OSC_SHM_
@@ -6,57 +6,82 @@
 #define _MICRO_OSC_SLIP_
 
 #include <MicroOsc.h>
-#include <MicroSlip.h>
+#include "MicroOscSlipCodec.h"
 
-template <const size_t MICRO_OSC_IN_SIZE>
+template <const size_t MICRO_OSC_IN_SIZE, class MicroOscPolicy = MicroOscChecked>
 class MicroOscSlip : public MicroOsc
 {
 protected:
-  MicroSlip slip_;
+  MicroOscSlipEncoder encoder_;
+  MicroOscSlipDecoder decoder_;
+  Stream *stream_;
   unsigned char input_buffer_[MICRO_OSC_IN_SIZE];
 
 protected:
   void transportBegin()
   {
-    slip_.beginPacket();
+    encoder_.beginPacket();
   }
   void transportEnd()
   {
-    slip_.endPacket();
+    encoder_.endPacket();
   }
   bool transportReady()
   {
     return true;
   }
+#ifndef MICRO_OSC_NO_QUEUE
+  size_t transportAvailableForWrite() override
+  {
+    // worst case: every byte is escaped, plus the two END bytes
+    int available = stream_->availableForWrite();
+    return (available > 2) ? (available - 2) / 2 : 0;
+  }
+  void transportWritten(size_t) override
+  {
+    // the budget only counts what is written now, nothing may wait in the chunk for the next drain
+    encoder_.flushChunk();
+  }
+#endif
 
 public:
-  MicroOscSlip(Stream *stream) : MicroOsc(&slip_), slip_(stream)
+  MicroOscSlip(Stream *stream) : MicroOsc(&encoder_), encoder_(stream), decoder_(input_buffer_, MICRO_OSC_IN_SIZE), stream_(stream)
   {
   }
 
-  MicroOscSlip(Stream &stream) : MicroOsc(&slip_), slip_(&stream)
+  MicroOscSlip(Stream &stream) : MicroOsc(&encoder_), encoder_(&stream), decoder_(input_buffer_, MICRO_OSC_IN_SIZE), stream_(&stream)
   {
   }
 
   void onOscMessageReceived(MicroOscCallback callback) override
   {
+    update();
 
-    size_t packetLength = slip_.parsePacket(input_buffer_, MICRO_OSC_IN_SIZE);
-    if (packetLength > 0)
+    decoder_.fill(stream_);
+    size_t packetLength;
+    size_t received = 0;
+    while (receiveBudgetLeft(received++) && (packetLength = decoder_.nextFrame()) > 0)
     {
-      MicroOsc::parseMessages(callback, input_buffer_, packetLength);
+      MicroOsc::parseMessages<MicroOscPolicy>(callback, input_buffer_, packetLength);
     }
+    MicroOsc::template dispatchCoalesced<MicroOscPolicy>(callback);
   }
 
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
   void onOscMessageReceived(MicroOscCallbackWithSource callback) override
   {
+    update();
 
-    size_t packetLength = slip_.parsePacket(input_buffer_, MICRO_OSC_IN_SIZE);
-    if (packetLength > 0)
+    decoder_.fill(stream_);
+    size_t packetLength;
+    size_t received = 0;
+    while (receiveBudgetLeft(received++) && (packetLength = decoder_.nextFrame()) > 0)
     {
-      MicroOsc::parseMessages(callback, input_buffer_, packetLength);
+      MicroOsc::parseMessages<MicroOscPolicy>(callback, input_buffer_, packetLength);
     }
+    MicroOsc::template dispatchCoalesced<MicroOscPolicy>(callback);
   }
+#endif
 
   [[deprecated("Use onOscMessageReceived(callback) instead.")]]
   void receiveMessages(MicroOscCallback callback)
@@ -65,4 +90,102 @@ public:
   }
 };
 
+/**
+ * SLIP transport that receives from an interrupt or a DMA callback instead of polling a Stream.
+ * Call feed() with the received bytes. onOscMessageReceived() only parses the completed frames.
+ * Two frames of MICRO_OSC_IN_SIZE bytes are reserved.
+ */
+template <const size_t MICRO_OSC_IN_SIZE, class MicroOscPolicy = MicroOscChecked>
+class MicroOscSlipFeed : public MicroOsc
+{
+protected:
+  MicroOscSlipEncoder encoder_;
+  MicroOscSlipFeeder feeder_;
+  Print *print_;
+  unsigned char banks_[2][MICRO_OSC_IN_SIZE];
+
+protected:
+  void transportBegin()
+  {
+    encoder_.beginPacket();
+  }
+  void transportEnd()
+  {
+    encoder_.endPacket();
+  }
+  bool transportReady()
+  {
+    return true;
+  }
+#ifndef MICRO_OSC_NO_QUEUE
+  size_t transportAvailableForWrite() override
+  {
+    int available = print_->availableForWrite();
+    return (available > 2) ? (available - 2) / 2 : 0;
+  }
+  void transportWritten(size_t) override
+  {
+    // the budget only counts what is written now, nothing may wait in the chunk for the next drain
+    encoder_.flushChunk();
+  }
+#endif
+
+  template <class Callback>
+  void receive(Callback callback)
+  {
+    update();
+
+    size_t packetLength;
+    unsigned char *packet = feeder_.frame(&packetLength);
+    if (packet != NULL)
+    {
+      MicroOsc::parseMessages<MicroOscPolicy>(callback, packet, packetLength);
+      feeder_.release();
+    }
+    MicroOsc::template dispatchCoalesced<MicroOscPolicy>(callback);
+  }
+
+public:
+  /**
+   * output : where the messages are sent (Serial for example).
+   */
+  MicroOscSlipFeed(Print *output) : MicroOsc(&encoder_), encoder_(output), feeder_(banks_[0], banks_[1], MICRO_OSC_IN_SIZE), print_(output)
+  {
+  }
+
+  MicroOscSlipFeed(Print &output) : MicroOsc(&encoder_), encoder_(&output), feeder_(banks_[0], banks_[1], MICRO_OSC_IN_SIZE), print_(&output)
+  {
+  }
+
+  /**
+   * Decodes received bytes. Safe to call from an interrupt.
+   */
+  void feed(uint8_t b)
+  {
+    feeder_.feed(b);
+  }
+
+  void feed(const uint8_t *data, size_t length)
+  {
+    feeder_.feed(data, length);
+  }
+
+  uint32_t getDroppedCount()
+  {
+    return feeder_.getDroppedCount();
+  }
+
+  void onOscMessageReceived(MicroOscCallback callback) override
+  {
+    receive(callback);
+  }
+
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+  void onOscMessageReceived(MicroOscCallbackWithSource callback) override
+  {
+    receive(callback);
+  }
+#endif
+};
+
 #endif // _MICRO_OSC_SLIP_
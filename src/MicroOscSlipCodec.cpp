@@ -0,0 +1,311 @@
+#include "MicroOscSlipCodec.h"
+
+// Non zero if one of the 4 bytes of v is zero
+#define MICRO_OSC_HAS_ZERO_BYTE(v) (((v) - 0x01010101UL) & ~(v) & 0x80808080UL)
+
+size_t microOscSlipCleanRun(const uint8_t *data, size_t length)
+{
+  size_t i = 0;
+  for (; i + 4 <= length; i += 4)
+  {
+    uint32_t v;
+    memcpy(&v, data + i, 4);
+    if (MICRO_OSC_HAS_ZERO_BYTE(v ^ 0xC0C0C0C0UL) | MICRO_OSC_HAS_ZERO_BYTE(v ^ 0xDBDBDBDBUL))
+      break;
+  }
+  while (i < length && data[i] != MICRO_OSC_SLIP_END && data[i] != MICRO_OSC_SLIP_ESC)
+    i++;
+  return i;
+}
+
+/***********
+  ENCODER
+************/
+
+MicroOscSlipEncoder::MicroOscSlipEncoder(Print *stream) : stream_(stream)
+{
+}
+
+void MicroOscSlipEncoder::flushChunk()
+{
+  if (chunk_length_ > 0)
+  {
+    stream_->write(chunk_, chunk_length_);
+    chunk_length_ = 0;
+  }
+}
+
+void MicroOscSlipEncoder::put(const uint8_t *data, size_t length)
+{
+  if (length > MICRO_OSC_SLIP_CHUNK_SIZE - chunk_length_)
+  {
+    flushChunk();
+    if (length >= MICRO_OSC_SLIP_CHUNK_SIZE)
+    {
+      stream_->write(data, length);
+      return;
+    }
+  }
+  memcpy(chunk_ + chunk_length_, data, length);
+  chunk_length_ += length;
+}
+
+void MicroOscSlipEncoder::beginPacket()
+{
+  // a leading END flushes any line noise received before the packet
+  const uint8_t end = MICRO_OSC_SLIP_END;
+  put(&end, 1);
+}
+
+void MicroOscSlipEncoder::endPacket()
+{
+  const uint8_t end = MICRO_OSC_SLIP_END;
+  put(&end, 1);
+  flushChunk();
+}
+
+size_t MicroOscSlipEncoder::write(uint8_t b)
+{
+  return write(&b, 1);
+}
+
+size_t MicroOscSlipEncoder::write(const uint8_t *data, size_t length)
+{
+  size_t left = length;
+  while (left > 0)
+  {
+    size_t run = microOscSlipCleanRun(data, left);
+    if (run > 0)
+    {
+      put(data, run);
+      data += run;
+      left -= run;
+      continue;
+    }
+    uint8_t escaped[2] = {MICRO_OSC_SLIP_ESC, (*data == MICRO_OSC_SLIP_END) ? (uint8_t)MICRO_OSC_SLIP_ESC_END : (uint8_t)MICRO_OSC_SLIP_ESC_ESC};
+    put(escaped, 2);
+    data++;
+    left--;
+  }
+  return length;
+}
+
+/***********
+  DECODER
+************/
+
+MicroOscSlipDecoder::MicroOscSlipDecoder(unsigned char *buffer, size_t size) : buffer_(buffer), size_(size)
+{
+}
+
+size_t MicroOscSlipDecoder::fill(Stream *stream)
+{
+  if (frame_ > 0)
+  {
+    length_ = 0;
+    frame_ = 0;
+  }
+  // the bytes of the previous fill() were not all decoded
+  if (raw_ < raw_end_ || complete_)
+    return 0;
+
+  int available = stream->available();
+  if (available <= 0)
+    return 0;
+
+  size_t room = size_ - length_;
+  if (room == 0)
+  {
+    if (stream->peek() == MICRO_OSC_SLIP_END && !escaping_)
+    {
+      stream->read();
+      complete_ = true;
+      return 1;
+    }
+    // too large, drop the frame up to its END
+    overflow_ = true;
+    length_ = 0;
+    room = size_;
+  }
+
+  raw_ = raw_end_ = length_;
+  size_t n = ((size_t)available < room) ? (size_t)available : room;
+  raw_end_ += stream->readBytes(buffer_ + raw_, n);
+  return raw_end_ - raw_;
+}
+
+size_t MicroOscSlipDecoder::nextFrame()
+{
+  if (frame_ > 0)
+  {
+    length_ = 0;
+    frame_ = 0;
+  }
+  if (complete_)
+  {
+    complete_ = false;
+    frame_ = length_;
+    return frame_;
+  }
+
+  // decoding in place is safe: length_ <= raw_ at all times
+  size_t w = length_;
+  size_t r = raw_;
+  while (r < raw_end_)
+  {
+    if (escaping_)
+    {
+      uint8_t b = buffer_[r++];
+      escaping_ = false;
+      if (!overflow_)
+        buffer_[w++] = (b == MICRO_OSC_SLIP_ESC_END) ? MICRO_OSC_SLIP_END : (b == MICRO_OSC_SLIP_ESC_ESC) ? MICRO_OSC_SLIP_ESC : b;
+      continue;
+    }
+
+    size_t run = microOscSlipCleanRun(buffer_ + r, raw_end_ - r);
+    if (run > 0)
+    {
+      if (!overflow_)
+      {
+        if (w != r)
+          memmove(buffer_ + w, buffer_ + r, run);
+        w += run;
+      }
+      r += run;
+      continue;
+    }
+
+    if (buffer_[r++] == MICRO_OSC_SLIP_ESC)
+    {
+      escaping_ = true;
+      continue;
+    }
+
+    // END
+    if (overflow_)
+    {
+      overflow_ = false;
+      w = 0;
+      continue;
+    }
+    if (w > 0)
+    {
+      length_ = w;
+      raw_ = r;
+      frame_ = w;
+      return frame_;
+    }
+  }
+  length_ = w;
+  raw_ = raw_end_ = r;
+  return 0;
+}
+
+/***********
+  FEEDER
+************/
+
+// Keeps the compiler from moving the writes of a frame after the flag that publishes it
+#if defined(__GNUC__)
+#define MICRO_OSC_COMPILER_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define MICRO_OSC_COMPILER_BARRIER()
+#endif
+
+MicroOscSlipFeeder::MicroOscSlipFeeder(unsigned char *bank0, unsigned char *bank1, size_t size)
+{
+  banks_[0] = bank0;
+  banks_[1] = bank1;
+  size_ = size;
+}
+
+void MicroOscSlipFeeder::put(const uint8_t *data, size_t length)
+{
+  if (overflow_)
+    return;
+  if (length > size_ - length_)
+  {
+    overflow_ = true;
+    return;
+  }
+  memcpy(banks_[writing_] + length_, data, length);
+  length_ += length;
+}
+
+void MicroOscSlipFeeder::end()
+{
+  if (overflow_)
+  {
+    dropped_ = dropped_ + 1;
+  }
+  else if (length_ > 0)
+  {
+    if (ready_)
+    {
+      // the main loop did not release the previous frame
+      dropped_ = dropped_ + 1;
+    }
+    else
+    {
+      ready_bank_ = writing_;
+      ready_length_ = length_;
+      MICRO_OSC_COMPILER_BARRIER();
+      ready_ = true;
+      writing_ ^= 1;
+    }
+  }
+  length_ = 0;
+  overflow_ = false;
+}
+
+void MicroOscSlipFeeder::feed(uint8_t b)
+{
+  feed(&b, 1);
+}
+
+void MicroOscSlipFeeder::feed(const uint8_t *data, size_t length)
+{
+  while (length > 0)
+  {
+    if (escaping_)
+    {
+      escaping_ = false;
+      uint8_t b = (*data == MICRO_OSC_SLIP_ESC_END) ? MICRO_OSC_SLIP_END : (*data == MICRO_OSC_SLIP_ESC_ESC) ? MICRO_OSC_SLIP_ESC : *data;
+      put(&b, 1);
+      data++;
+      length--;
+      continue;
+    }
+
+    size_t run = microOscSlipCleanRun(data, length);
+    if (run > 0)
+    {
+      put(data, run);
+      data += run;
+      length -= run;
+      continue;
+    }
+
+    if (*data == MICRO_OSC_SLIP_ESC)
+      escaping_ = true;
+    else
+      end();
+    data++;
+    length--;
+  }
+}
+
+unsigned char *MicroOscSlipFeeder::frame(size_t *length)
+{
+  if (!ready_)
+    return NULL;
+  MICRO_OSC_COMPILER_BARRIER();
+  *length = ready_length_;
+  return banks_[ready_bank_];
+}
+
+void MicroOscSlipFeeder::release()
+{
+  MICRO_OSC_COMPILER_BARRIER();
+  ready_ = false;
+}
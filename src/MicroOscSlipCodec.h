@@ -0,0 +1,156 @@
+/* MicroOscSlipCodec
+ * By Thomas O Fredericks (tof@tofstuff.com)
+ */
+
+#ifndef _MICRO_OSC_SLIP_CODEC_
+#define _MICRO_OSC_SLIP_CODEC_
+
+#include <Arduino.h>
+#include "Print.h"
+#include "Stream.h"
+
+#define MICRO_OSC_SLIP_END 0xC0
+#define MICRO_OSC_SLIP_ESC 0xDB
+#define MICRO_OSC_SLIP_ESC_END 0xDC
+#define MICRO_OSC_SLIP_ESC_ESC 0xDD
+
+// Bytes of escaped output gathered before they are written to the stream
+#ifndef MICRO_OSC_SLIP_CHUNK_SIZE
+#define MICRO_OSC_SLIP_CHUNK_SIZE 64
+#endif
+
+/**
+ * Returns the number of bytes at the start of data that are neither END nor ESC.
+ * The data is scanned 4 bytes at a time.
+ */
+size_t microOscSlipCleanRun(const uint8_t *data, size_t length);
+
+/**
+ * SLIP encoder used as the output of MicroOscSlip.
+ * Runs of bytes that do not need escaping are copied with memcpy into a small chunk
+ * that is written to the stream with a single write() call. Runs larger than the chunk
+ * (blobs, bundles, forwarded packets) are written to the stream directly.
+ */
+class MicroOscSlipEncoder : public Print
+{
+	Print *stream_;
+	uint8_t chunk_[MICRO_OSC_SLIP_CHUNK_SIZE];
+	size_t chunk_length_ = 0;
+
+private:
+	void put(const uint8_t *data, size_t length);
+
+public:
+	MicroOscSlipEncoder(Print *stream);
+
+	void beginPacket();
+	void endPacket();
+
+	/**
+	 * Writes the bytes gathered in the chunk to the stream without ending the packet.
+	 */
+	void flushChunk();
+
+	size_t write(uint8_t b) override;
+	size_t write(const uint8_t *data, size_t length) override;
+	using Print::write;
+};
+
+/**
+ * In place SLIP decoder used as the input of MicroOscSlip.
+ * fill() reads every available byte with a single readBytes() call into the free end of the buffer.
+ * nextFrame() then decodes those bytes over themselves (the decoded data is never longer
+ * than the escaped data) and returns each complete frame.
+ * A frame larger than the buffer is dropped.
+ */
+class MicroOscSlipDecoder
+{
+	unsigned char *buffer_;
+	size_t size_;
+	size_t length_ = 0;  // decoded bytes of the current frame
+	size_t raw_ = 0;     // next escaped byte to decode
+	size_t raw_end_ = 0; // end of the escaped bytes
+	size_t frame_ = 0;   // length of the frame returned by the last nextFrame()
+	bool escaping_ = false;
+	bool overflow_ = false;
+	bool complete_ = false; // the END of a frame that fills the whole buffer was read
+
+public:
+	MicroOscSlipDecoder(unsigned char *buffer, size_t size);
+
+	/**
+	 * Reads the bytes available in the stream. Returns the number of bytes read.
+	 */
+	size_t fill(Stream *stream);
+
+	/**
+	 * Decodes the bytes read by fill(). Returns the length of the next complete frame,
+	 * that starts at the beginning of the buffer, or 0 if there is none.
+	 * The frame is valid until the next call.
+	 */
+	size_t nextFrame();
+};
+
+/**
+ * SLIP decoder fed from an interrupt (UART RX, DMA with idle line detection...) into two frame banks.
+ * feed() decodes into one bank while the other one holds the last complete frame until the main loop
+ * releases it. A frame completed while the previous one was not released is dropped.
+ * feed() must always be called from the same context (one interrupt).
+ */
+class MicroOscSlipFeeder
+{
+	unsigned char *banks_[2];
+	size_t size_;
+	// written by feed() only
+	uint8_t writing_ = 0; // bank being decoded
+	size_t length_ = 0;
+	bool escaping_ = false;
+	bool overflow_ = false;
+	volatile uint32_t dropped_ = 0;
+	// handed from feed() to the main loop
+	volatile uint8_t ready_bank_ = 0;
+	volatile size_t ready_length_ = 0;
+	volatile bool ready_ = false;
+
+private:
+	void put(const uint8_t *data, size_t length);
+	void end();
+
+public:
+	MicroOscSlipFeeder(unsigned char *bank0, unsigned char *bank1, size_t size);
+
+	/**
+	 * Decodes received bytes. Safe to call from an interrupt.
+	 */
+	void feed(uint8_t b);
+	void feed(const uint8_t *data, size_t length);
+
+	/**
+	 * Returns the complete frame, or NULL if there is none. The frame is valid until release().
+	 */
+	unsigned char *frame(size_t *length);
+
+	/**
+	 * Gives the bank of the frame back to feed().
+	 */
+	void release();
+
+	/**
+	 * Returns the number of frames dropped because the previous frame was not released or because they were too large.
+	 */
+	uint32_t getDroppedCount()
+	{
+#if defined(__AVR__)
+		// 32 bits are read one byte at a time, feed() must not change them in between
+		uint8_t sreg = SREG;
+		cli();
+		uint32_t dropped = dropped_;
+		SREG = sreg;
+		return dropped;
+#else
+		return dropped_;
+#endif
+	}
+};
+
+#endif // _MICRO_OSC_SLIP_CODEC_
@@ -11,13 +11,19 @@
 #include <Udp.h>
 
 
-template <const size_t MICRO_OSC_IN_SIZE>
+template <const size_t MICRO_OSC_IN_SIZE, class MicroOscPolicy = MicroOscChecked>
 class MicroOscUdp : public MicroOsc {
 protected:
     UDP* udp;
     unsigned char inputBuffer[MICRO_OSC_IN_SIZE];
     IPAddress destinationIp = INADDR_NONE;
     unsigned int destinationPort;
+#ifndef MICRO_OSC_NO_QUEUE
+    uint32_t pacingRate = 0; // bytes per second, 0 when pacing is disabled
+    int32_t pacingBurst = 0;
+    int32_t pacingTokens = 0;
+    unsigned long pacingLast = 0;
+#endif
 
 protected:
 	virtual void transportBegin() {
@@ -40,6 +46,25 @@ protected:
     return destinationIp != INADDR_NONE;
   }
 
+#ifndef MICRO_OSC_NO_QUEUE
+  // Token bucket: each byte of the queue sent takes a token, a datagram larger than the tokens left is finished later
+  size_t transportAvailableForWrite() override {
+    if ( pacingRate == 0 ) return SIZE_MAX;
+    unsigned long now = micros();
+    uint32_t added = (uint64_t)(now - pacingLast) * pacingRate / 1000000UL;
+    if ( added > 0 ) {
+      pacingLast += (uint64_t)added * 1000000UL / pacingRate;
+      pacingTokens = ( (int64_t)pacingTokens + added > pacingBurst ) ? pacingBurst : pacingTokens + added;
+    }
+    return ( pacingTokens > 0 ) ? (size_t)pacingTokens : 0;
+  }
+
+  void transportWritten(size_t length) override {
+    if ( pacingRate == 0 ) return;
+    pacingTokens -= length;
+  }
+#endif
+
   public:
     MicroOscUdp(UDP * udp, IPAddress destinationIp, unsigned int destinationPort) : MicroOsc(udp) {
     	this->udp = udp;
@@ -64,24 +89,36 @@ protected:
     }
 
 
-    void onOscMessageReceived(MicroOscCallback callback) override {
-      size_t packetLength = udp->parsePacket();
-      if ( packetLength > 0 ) {
+    template <class Callback>
+    void receive(Callback callback) {
+      update();
+      // with a coalescer, every pending datagram is read so only the newest values are dispatched
+#ifndef MICRO_OSC_NO_COALESCER
+      size_t limit = ( receiveBudget > 0 ) ? receiveBudget : ( coalescer ? MICRO_OSC_DRAIN_LIMIT : 1 );
+#else
+      size_t limit = ( receiveBudget > 0 ) ? receiveBudget : 1;
+#endif
+      size_t drained = 0;
+      size_t packetLength;
+      while ( drained < limit && (packetLength = udp->parsePacket()) > 0 ) {
         packetLength = udp->read(inputBuffer, MICRO_OSC_IN_SIZE);
       	
-        MicroOsc::parseMessages( callback , inputBuffer , packetLength);
+        MicroOsc::parseMessages<MicroOscPolicy>( callback , inputBuffer , packetLength);
+        drained++;
       }
+      MicroOsc::template dispatchCoalesced<MicroOscPolicy>(callback);
     }
 
-      void onOscMessageReceived(MicroOscCallbackWithSource callback) override {
-      size_t packetLength = udp->parsePacket();
-      if ( packetLength > 0 ) {
-        packetLength = udp->read(inputBuffer, MICRO_OSC_IN_SIZE);
-      	
-        MicroOsc::parseMessages( callback , inputBuffer , packetLength);
-      }
+    void onOscMessageReceived(MicroOscCallback callback) override {
+      receive(callback);
     }
 
+#ifndef MICRO_OSC_NO_SOURCE_CALLBACK
+    void onOscMessageReceived(MicroOscCallbackWithSource callback) override {
+      receive(callback);
+    }
+#endif
+
     [[deprecated("Use onOscMessageReceived(callback) instead.")]]
     void receiveMessages(MicroOscCallback callback) {
         onOscMessageReceived(callback);
@@ -92,6 +129,20 @@ protected:
       this->destinationPort = destinationPort;
     }
 
+#ifndef MICRO_OSC_NO_QUEUE
+    /**
+     * Limits the rate at which the transmit queue (see setTransmitQueue()) is sent.
+     * bytesPerSecond : average rate, 0 to disable pacing.
+     * burstBytes : bytes that can be sent at once after a pause.
+     */
+    void setPacing(uint32_t bytesPerSecond, int32_t burstBytes) {
+      pacingRate = bytesPerSecond;
+      pacingBurst = burstBytes;
+      pacingTokens = burstBytes;
+      pacingLast = micros();
+    }
+#endif
+
 };
 
 
@@ -52,4 +52,63 @@ static inline int64_t swapBigEndian64(int64_t x)
 #endif
 }
 
+#define MICRO_OSC_HASH_SEED 2166136261UL
+
+/*
+ FNV-1a hash of the characters of text, continued from h to hash several strings
+ */
+static inline uint32_t microOscHash(const char *text, uint32_t h = MICRO_OSC_HASH_SEED)
+{
+    while (*text)
+    {
+        h ^= (uint8_t)*text++;
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static inline uint16_t microOscFoldHash(uint32_t h)
+{
+    return (uint16_t)(h ^ (h >> 16));
+}
+
+#if defined(__linux__) && defined(__cplusplus)
+
+#include <atomic>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static inline long microOscFutex(std::atomic<uint32_t> *word, int op, uint32_t value, const struct timespec *timeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), op, value, timeout, NULL, 0);
+}
+
+/*
+ Sleeps until head is no longer value or timeoutMicros is over.
+ waiting is set while sleeping so the writer knows it must call microOscFutexWake().
+ */
+static inline void microOscFutexWait(std::atomic<uint32_t> *head, std::atomic<uint32_t> *waiting, uint32_t value, uint32_t timeoutMicros)
+{
+    waiting->store(1, std::memory_order_seq_cst);
+    // the writer may have published between the check of the caller and the waiting flag
+    if (head->load(std::memory_order_seq_cst) == value)
+    {
+        struct timespec timeout;
+        timeout.tv_sec = timeoutMicros / 1000000UL;
+        timeout.tv_nsec = (timeoutMicros % 1000000UL) * 1000UL;
+        microOscFutex(head, FUTEX_WAIT, value, &timeout);
+    }
+    waiting->store(0, std::memory_order_relaxed);
+}
+
+static inline void microOscFutexWake(std::atomic<uint32_t> *head)
+{
+    microOscFutex(head, FUTEX_WAKE, INT_MAX, NULL);
+}
+
+#endif // __linux__
+
 #endif
\ No newline at end of file